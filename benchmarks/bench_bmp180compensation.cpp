@@ -0,0 +1,114 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_benchmarks
+ *
+ * \brief Benchmarks for Sensors::Bmp180Compensation.
+ */
+
+#include <math.h>
+
+#include "benchmark.h"
+
+#include "lib/bmp180compensation.h"
+
+using ::Sensors::Bmp180Compensation;
+
+namespace
+{
+// EEPROM content of a real sensor
+const uint8_t c_eeprom[Bmp180Compensation::c_calibrationSize] = {
+    0x1E, 0xE7, 0xFC, 0x5A, 0xC8, 0x1E, 0x7B, 0x4F, 0x64, 0x47, 0x4A, 0x1E,
+    0x15, 0x7A, 0x00, 0x2E, 0x80, 0x00, 0xD4, 0xBD, 0x09, 0x80
+};
+
+// Floating point polynomials as previously used by Avr::Bmp180
+struct FloatCompensation
+{
+    float fc5, fc6, fmc, fmd, fx0, fx1, fx2, fy0, fy1, fy2, fp0, fp1, fp2;
+
+    explicit FloatCompensation(const uint8_t *data)
+    {
+        auto coefficient = [data](uint8_t index) {
+            return static_cast<int16_t>(Sensors::word(data[2 * index],
+                                                      data[2 * index + 1]));
+        };
+        float fc3 = 160.0 * pow(2, -15) * coefficient(2);
+        float fc4 = pow(10, -3) * pow(2, -15) *
+                static_cast<uint16_t>(coefficient(3));
+        float fb1 = pow(160, 2) * pow(2, -30) * coefficient(6);
+        fc5 = (pow(2, -15) / 160) * static_cast<uint16_t>(coefficient(4));
+        fc6 = static_cast<uint16_t>(coefficient(5));
+        fmc = (pow(2, 11) / pow(160, 2)) * coefficient(9);
+        fmd = coefficient(10) / 160.0;
+        fx0 = coefficient(0);
+        fx1 = 160.0 * pow(2, -13) * coefficient(1);
+        fx2 = pow(160, 2) * pow(2, -25) * coefficient(7);
+        fy0 = fc4 * pow(2, 15);
+        fy1 = fc4 * fc3;
+        fy2 = fc4 * fb1;
+        fp0 = (3791.0 - 8.0) / 1600.0;
+        fp1 = 1.0 - 7357.0 * pow(2, -20);
+        fp2 = 3038.0 * 100.0 * pow(2, -36);
+    }
+
+    float calculate(uint16_t ut, uint32_t up, int16_t altitude) const
+    {
+        float a = fc5 * (ut - fc6);
+        float temperature = a + (fmc / (a + fmd));
+        float pu = ((up >> 16) * 256.00) + ((up >> 8) & 0xFF) +
+                ((up & 0xFF) / 256.00);
+        float s = temperature - 25.0;
+        float x = (fx2 * pow(s, 2)) + (fx1 * s) + fx0;
+        float y = (fy2 * pow(s, 2)) + (fy1 * s) + fy0;
+        float z = (pu - x) / y;
+        float pressure = (fp2 * pow(z, 2)) + (fp1 * z) + fp0;
+        return pressure /
+                pow(1.0f - (static_cast<float>(altitude) / 44330.0f), 5.255f);
+    }
+};
+}  // namespace
+
+/*!
+ * \brief Cost of calculating the pressure at sea level with floating point
+ *        polynomials compared to the integer algorithm of
+ *        Sensors::Bmp180Compensation.
+ */
+BENCHMARK(Bmp180SeaLevelPressure)
+{
+    const uint32_t iterations = 1000000;
+    // Volatile inputs prevent constant folding of the calculation
+    volatile uint16_t ut = 27600;
+    volatile uint32_t up = 0x9C4A80;
+
+    FloatCompensation floatCompensation(c_eeprom);
+    runner.measure("Float polynomials", iterations, [&] {
+        Benchmarks::doNotOptimize(floatCompensation.calculate(ut, up, 470));
+    });
+
+    Bmp180Compensation compensation;
+    compensation.setCalibration(c_eeprom);
+    runner.measure("Integer (datasheet)", iterations, [&] {
+        compensation.calculate(ut, up, 3);
+        Benchmarks::doNotOptimize(compensation.pressureAtSeaLevel(
+                Bmp180Compensation::seaLevelFactor<470>()));
+    });
+}
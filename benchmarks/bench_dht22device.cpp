@@ -0,0 +1,92 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_benchmarks
+ *
+ * \brief Benchmarks for Sensors::Dht22Device.
+ */
+
+#include "benchmark.h"
+
+#include "lib/dht22sensor.h"
+
+using ::Sensors::Dht22Device;
+using ::Sensors::RfDeviceStatus;
+
+namespace
+{
+
+const uint8_t c_frame[] = {0x02, 0x8C, 0x01, 0x5F, 0xEE};
+
+// High pulse widths (in us) of c_frame
+struct PulseWidths
+{
+    PulseWidths()
+    {
+        uint8_t index = 0;
+        for (auto byte : c_frame) {
+            for (int bit = 7; bit >= 0; --bit) {
+                values[index++] = (byte >> bit) & 1 ? 70 : 26;
+            }
+        }
+    }
+
+    uint16_t values[40];
+};
+
+// Reference implementation with a hand-written bit loop as used by the
+// blocking Avr::Dht22
+bool decodeHandWritten(const PulseWidths &pulseWidths, uint8_t (&bits)[5])
+{
+    for (uint8_t i = 0; i < 40; ++i) {
+        Sensors::bitWrite(bits[i / 8], 7 - i % 8,
+                          pulseWidths.values[i] >= 48);
+    }
+    return (uint8_t)(bits[0] + bits[1] + bits[2] + bits[3]) == bits[4];
+}
+
+}  // namespace
+
+/*!
+ * \brief Cost per frame of decoding DHT22 pulse widths with
+ *        Sensors::Dht22Device.
+ */
+BENCHMARK(Dht22DeviceFrame)
+{
+    const uint32_t iterations = 1000000;
+    const PulseWidths pulseWidths;
+
+    runner.measure("hand-written bit loop", iterations, [&] {
+        uint8_t bits[5] = {};
+        Benchmarks::doNotOptimize(decodeHandWritten(pulseWidths, bits));
+        Benchmarks::doNotOptimize(bits);
+    });
+
+    Dht22Device<10, 48, 48, 100> device;
+    runner.measure("Demodulator/BitDecoder/Sensor pipeline", iterations, [&] {
+        device.reset();
+        auto status = RfDeviceStatus::Incomplete;
+        for (auto pulseWidth : pulseWidths.values) {
+            status = device.addPulseWidth(pulseWidth);
+        }
+        Benchmarks::doNotOptimize(status);
+    });
+}
@@ -0,0 +1,67 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_benchmarks
+ *
+ * \brief Benchmarks for Sensors::HidekiSensor.
+ */
+
+#include "benchmark.h"
+
+#include "lib/hidekisensor.h"
+
+using ::Sensors::HidekiSensor;
+using ::Sensors::SensorStatus;
+
+namespace
+{
+
+const uint8_t c_frame[] = {0x9F, 0x2C, 0xCE, 0x5E, 0x48,
+                           0xC2, 0x16, 0xFB, 0xDB, 0xFC};
+
+SensorStatus addFrame(HidekiSensor &sensor)
+{
+    sensor.reset();
+    auto status = SensorStatus::Incomplete;
+    for (auto byte : c_frame) {
+        status = sensor.addByte(byte);
+    }
+    return status;
+}
+
+}  // namespace
+
+/*!
+ * \brief Cost per frame of adding bytes to Sensors::HidekiSensor including
+ *        the CRC validation after every byte.
+ *
+ * The CRCs are only calculated once the CRC bytes have been received, so
+ * the validation after every byte doesn't grow with the frame length.
+ */
+BENCHMARK(HidekiSensorFrame)
+{
+    const uint32_t iterations = 1000000;
+
+    HidekiSensor sensor;
+    runner.measure("HidekiSensor", iterations, [&] {
+        Benchmarks::doNotOptimize(addFrame(sensor));
+    });
+}
@@ -0,0 +1,82 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_benchmarks
+ *
+ * \brief Benchmarks for Sensors::JsonWriter.
+ */
+
+#include <stdio.h>
+
+#include "benchmark.h"
+
+#include "lib/jsonwriter.h"
+
+using ::Sensors::BufferSink;
+using ::Sensors::JsonWriter;
+using ::Sensors::SensorValue;
+
+/*!
+ * \brief Cost of formatting a Hideki sensor JSON line with snprintf compared
+ *        to Sensors::JsonWriter.
+ */
+BENCHMARK(JsonWriterHidekiLine)
+{
+    const uint32_t iterations = 1000000;
+    const uint8_t channel = 2;
+    const auto temperature = SensorValue::fromRaw(-512);
+    const uint8_t humidity = 48;
+    const bool battery = true;
+    char str[128];
+
+    runner.measure("snprintf %.2f (float)", iterations, [&] {
+        snprintf(str, sizeof(str),
+                 "{\"rf433_%d\":{\"temperature\":%.2f,\"humidity\":%d,"
+                 "\"battery\":%s}}\n",
+                 channel, temperature.raw() / 100.0, humidity,
+                 battery ? "true" : "false");
+        Benchmarks::doNotOptimize(str);
+    });
+
+    runner.measure("snprintf %s (FixedPoint)", iterations, [&] {
+        char value[SensorValue::formatSize()];
+        temperature.format(value, sizeof(value));
+        snprintf(str, sizeof(str),
+                 "{\"rf433_%d\":{\"temperature\":%s,\"humidity\":%d,"
+                 "\"battery\":%s}}\n",
+                 channel, value, humidity, battery ? "true" : "false");
+        Benchmarks::doNotOptimize(str);
+    });
+
+    runner.measure("JsonWriter", iterations, [&] {
+        BufferSink sink(str, sizeof(str));
+        JsonWriter<BufferSink> json(sink);
+        json.beginObject();
+        json.beginObject(FLASH_STRING("rf433_"), channel);
+        json.addValue(FLASH_STRING("temperature"), temperature);
+        json.addUInt(FLASH_STRING("humidity"), humidity);
+        json.addBool(FLASH_STRING("battery"), battery);
+        json.endObject();
+        json.endObject();
+        sink.write('\n');
+        Benchmarks::doNotOptimize(str);
+    });
+}
@@ -0,0 +1,129 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_benchmarks
+ *
+ * \brief Benchmarks for Sensors::WireFrame and Sensors::WireDecoder.
+ */
+
+#include <stdio.h>
+
+#include "benchmark.h"
+
+#include "lib/jsonwriter.h"
+#include "lib/wireformat.h"
+
+using ::Sensors::BufferSink;
+using ::Sensors::JsonWriter;
+using ::Sensors::SensorStatus;
+using ::Sensors::SensorValue;
+using ::Sensors::WireDecoder;
+using ::Sensors::WireFrame;
+using ::Sensors::WireQuantity;
+using ::Sensors::WireSensor;
+using ::Sensors::wireSensorId;
+
+namespace
+{
+const uint8_t c_channel = 2;
+const SensorValue c_temperature = SensorValue::fromRaw(-512);
+const SensorValue c_humidity = 48;
+const SensorValue c_battery = 1;
+
+void encodeHideki(WireFrame<32> &frame, BufferSink &sink, uint8_t sequence)
+{
+    uint8_t id = wireSensorId(WireSensor::Rf433, c_channel);
+    frame.begin(sequence);
+    frame.add(id, WireQuantity::Temperature, c_temperature);
+    frame.add(id, WireQuantity::Humidity, c_humidity);
+    frame.add(id, WireQuantity::Battery, c_battery);
+    frame.encode(sink);
+}
+}  // namespace
+
+/*!
+ * \brief Cost and size of encoding a Hideki sensor reading as JSON line
+ *        compared to a binary Sensors::WireFrame.
+ */
+BENCHMARK(WireFrameEncodeHideki)
+{
+    const uint32_t iterations = 1000000;
+    char str[128];
+    char label[40];
+    BufferSink sink(str, sizeof(str));
+
+    auto encodeJson = [&] {
+        sink.reset();
+        JsonWriter<BufferSink> json(sink);
+        json.beginObject();
+        json.beginObject(FLASH_STRING("rf433_"), c_channel);
+        json.addValue(FLASH_STRING("temperature"), c_temperature);
+        json.addValue(FLASH_STRING("humidity"), c_humidity);
+        json.addBool(FLASH_STRING("battery"), c_battery.raw() != 0);
+        json.endObject();
+        json.endObject();
+        sink.write('\n');
+        Benchmarks::doNotOptimize(str);
+    };
+    encodeJson();
+    snprintf(label, sizeof(label), "JsonWriter (%u bytes)", sink.length());
+    runner.measure(label, iterations, encodeJson);
+
+    WireFrame<32> frame;
+    uint8_t sequence = 0;
+    auto encodeBinary = [&] {
+        sink.reset();
+        encodeHideki(frame, sink, sequence++);
+        Benchmarks::doNotOptimize(str);
+    };
+    encodeBinary();
+    snprintf(label, sizeof(label), "WireFrame (%u bytes)", sink.length());
+    runner.measure(label, iterations, encodeBinary);
+}
+
+/*!
+ * \brief Throughput of decoding a stream of binary frames with
+ *        Sensors::WireDecoder.
+ */
+BENCHMARK(WireDecoderThroughput)
+{
+    // Stream of 64 consecutive frames
+    char str[64 * 32];
+    BufferSink sink(str, sizeof(str));
+    WireFrame<32> frame;
+    for (uint8_t i = 0; i < 64; ++i) {
+        encodeHideki(frame, sink, i);
+    }
+    const uint16_t length = sink.length();
+
+    const uint32_t iterations = 10000;
+    char label[40];
+    WireDecoder<64> decoder;
+    uint32_t frames = 0;
+    snprintf(label, sizeof(label), "WireDecoder (%u bytes)", length);
+    runner.measure(label, iterations, [&] {
+        for (uint16_t i = 0; i < length; ++i) {
+            if (decoder.addByte(str[i]) == SensorStatus::Complete)
+                ++frames;
+        }
+        Benchmarks::doNotOptimize(frames);
+    });
+}
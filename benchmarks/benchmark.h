@@ -0,0 +1,174 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#pragma once
+
+/*!
+ * \file
+ * \ingroup libsensors_benchmarks
+ *
+ * \brief Minimal benchmark harness.
+ *
+ * Benchmarks are registered with the BENCHMARK() macro and executed by the
+ * `benchmarks` executable. Each benchmark measures one or more operations
+ * with Benchmarks::Runner::measure().
+ *
+ * \note Being executed on the host, the benchmarks can make use of STL.
+ */
+
+#include <inttypes.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/*!
+ * \addtogroup libsensors_benchmarks
+ * \{
+ */
+
+/*!
+ * \brief Namespace containing the benchmark harness.
+ */
+namespace Benchmarks
+{
+
+/*!
+ * \brief Prevents the compiler from optimizing away the computation of
+ *        \p value.
+ * \tparam T Data type of the \p value.
+ * \param value The value that has to be computed.
+ */
+template <typename T>
+inline void doNotOptimize(const T &value)
+{
+    __asm__ __volatile__("" : : "r,m"(value) : "memory");
+}
+
+/*!
+ * \brief Executes and reports measurements of a benchmark.
+ */
+class Runner
+{
+public:
+    /*!
+     * \brief Initializes the runner for the benchmark \p name.
+     * \param name Name of the benchmark.
+     */
+    explicit Runner(const char *name) : m_name(name)
+    {
+    }
+
+    /*!
+     * \brief Measures the average execution time of \p function.
+     *
+     * \tparam TFunction Callable without arguments.
+     * \param label Label of the measurement.
+     * \param iterations Number of executions of \p function.
+     * \param function The operation to measure.
+     * \return Average execution time in ns.
+     */
+    template <typename TFunction>
+    double measure(const char *label, uint32_t iterations, TFunction function)
+    {
+        // Warm up caches and branch predictors
+        for (uint32_t i = 0; i < iterations / 10 + 1; ++i) {
+            function();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; ++i) {
+            function();
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        double ns = std::chrono::duration<double, std::nano>(
+                    end - start).count() / iterations;
+        std::printf("%-28s %-36s %12.1f ns\n", m_name, label, ns);
+        return ns;
+    }
+
+private:
+    const char *m_name;
+};
+
+/*!
+ * \brief A registered benchmark.
+ */
+struct Benchmark
+{
+    /*! Name of the benchmark. */
+    const char *name;
+
+    /*! Function executing the benchmark. */
+    void (*function)(Runner &);
+};
+
+/*!
+ * \brief Returns all registered benchmarks.
+ * \return All registered benchmarks.
+ */
+inline std::vector<Benchmark> &registry()
+{
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+/*!
+ * \brief Registers a benchmark on construction.
+ */
+struct Registration
+{
+    /*!
+     * \brief Registers the benchmark \p function as \p name.
+     * \param name Name of the benchmark.
+     * \param function Function executing the benchmark.
+     */
+    Registration(const char *name, void (*function)(Runner &))
+    {
+        registry().push_back({name, function});
+    }
+};
+
+}  // namespace Benchmarks
+
+/*!
+ * \brief Defines and registers a benchmark.
+ *
+ * Usage:
+ * \code
+ * BENCHMARK(MyBenchmark)
+ * {
+ *     runner.measure("operation", 1000, [] {
+ *         // ...
+ *     });
+ * }
+ * \endcode
+ *
+ * \param name Name of the benchmark (has to be a valid identifier).
+ *
+ * \hideinitializer
+ */
+#define BENCHMARK(name) \
+    static void name(Benchmarks::Runner &runner); \
+    static Benchmarks::Registration name##Registration(#name, name); \
+    static void name(Benchmarks::Runner &runner)
+
+/*! \} */
@@ -0,0 +1,43 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_benchmarks
+ *
+ * \brief Executes all registered benchmarks.
+ *
+ * Usage: `benchmarks [filter]`. Only benchmarks with \a filter in their name
+ * are executed if a filter is given.
+ */
+
+#include "benchmark.h"
+
+int main(int argc, char *argv[])
+{
+    const char *filter = argc > 1 ? argv[1] : "";
+    for (const auto &benchmark : Benchmarks::registry()) {
+        if (std::strstr(benchmark.name, filter) == nullptr)
+            continue;
+
+        Benchmarks::Runner runner(benchmark.name);
+        benchmark.function(runner);
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+# - RAM report
+# Prints the static RAM usage (.data and .bss sections) per module based on
+# the map file of a linked AVR executable.
+#
+# Usage: cmake -DMAP_FILE=<file.map> -P RamReport.cmake
+
+include(${CMAKE_CURRENT_LIST_DIR}/Utils.cmake)
+
+# Convert hexadecimal string (with 0x prefix) to decimal
+function(hex_to_decimal _HEX _DEST)
+    string(TOLOWER "${_HEX}" _HEX)
+    string(REGEX REPLACE "^0x0*" "" _HEX "${_HEX}")
+    set(_DIGITS 0 1 2 3 4 5 6 7 8 9 a b c d e f)
+    set(_VALUE 0)
+    string(LENGTH "${_HEX}" _LENGTH)
+    set(_INDEX 0)
+    while(_INDEX LESS _LENGTH)
+        string(SUBSTRING "${_HEX}" ${_INDEX} 1 _CHAR)
+        list(FIND _DIGITS ${_CHAR} _DIGIT)
+        math(EXPR _VALUE "${_VALUE} * 16 + ${_DIGIT}")
+        math(EXPR _INDEX "${_INDEX} + 1")
+    endwhile()
+    set(${_DEST} ${_VALUE} PARENT_SCOPE)
+endfunction()
+
+if(NOT EXISTS "${MAP_FILE}")
+    message(FATAL_ERROR "Map file '${MAP_FILE}' does not exist")
+endif()
+
+# Skip the discarded input sections
+file(READ ${MAP_FILE} _MAP)
+string(FIND "${_MAP}" "Linker script and memory map" _START)
+if(_START LESS 0)
+    message(FATAL_ERROR "Invalid map file '${MAP_FILE}'")
+endif()
+string(SUBSTRING "${_MAP}" ${_START} -1 _MAP)
+
+# Input sections: " <section> [newline] <address> <size> <object>"
+set(_SECTION_REGEX
+    "\n (\\.(data|rodata|bss|noinit)[^ \n]*|COMMON)[ \n]+0x[0-9a-fA-F]+ +")
+set(_SECTION_REGEX "${_SECTION_REGEX}(0x[0-9a-fA-F]+) +([^\n]+)")
+string(REGEX MATCHALL "${_SECTION_REGEX}" _SECTIONS "${_MAP}")
+
+set(_MODULES)
+set(_TOTAL_DATA 0)
+set(_TOTAL_BSS 0)
+foreach(_SECTION ${_SECTIONS})
+    string(REGEX REPLACE "${_SECTION_REGEX}" "\\1" _NAME "${_SECTION}")
+    string(REGEX REPLACE "${_SECTION_REGEX}" "\\3" _SIZE "${_SECTION}")
+    string(REGEX REPLACE "${_SECTION_REGEX}" "\\4" _OBJECT "${_SECTION}")
+    hex_to_decimal(${_SIZE} _SIZE)
+    if(NOT _SIZE EQUAL 0)
+        # Archive members are reported as "<archive>(<member>)"
+        if(_OBJECT MATCHES "\\(([^)]+)\\)$")
+            set(_MODULE ${CMAKE_MATCH_1})
+        else()
+            get_filename_component(_MODULE "${_OBJECT}" NAME)
+        endif()
+        string(REGEX REPLACE "\\.(obj|o)$" "" _MODULE "${_MODULE}")
+        string(MAKE_C_IDENTIFIER "${_MODULE}" _ID)
+
+        if(_NAME MATCHES "^\\.(data|rodata)")
+            set(_TYPE DATA)
+        else()
+            set(_TYPE BSS)
+        endif()
+
+        list(FIND _MODULES ${_MODULE} _INDEX)
+        if(_INDEX LESS 0)
+            list(APPEND _MODULES ${_MODULE})
+            set(_DATA_${_ID} 0)
+            set(_BSS_${_ID} 0)
+        endif()
+        math(EXPR _${_TYPE}_${_ID} "${_${_TYPE}_${_ID}} + ${_SIZE}")
+        math(EXPR _TOTAL_${_TYPE} "${_TOTAL_${_TYPE}} + ${_SIZE}")
+    endif()
+endforeach()
+
+# Sort modules by their total size (descending)
+set(_LINES)
+foreach(_MODULE ${_MODULES})
+    string(MAKE_C_IDENTIFIER "${_MODULE}" _ID)
+    math(EXPR _TOTAL "${_DATA_${_ID}} + ${_BSS_${_ID}}")
+    string_padding("${_DATA_${_ID}}" 8 _DATA)
+    string_padding("${_BSS_${_ID}}" 8 _BSS)
+    string_padding("${_MODULE}" 32 _MODULE)
+    math(EXPR _KEY "100000 + ${_TOTAL}")
+    list(APPEND _LINES "${_KEY}${_MODULE}${_DATA}${_BSS}${_TOTAL}")
+endforeach()
+if(_LINES)
+    list(SORT _LINES)
+    list(REVERSE _LINES)
+endif()
+
+math(EXPR _TOTAL "${_TOTAL_DATA} + ${_TOTAL_BSS}")
+string_padding("Module" 32 _HEADER)
+string_padding("${_HEADER}.data" 40 _HEADER)
+string_padding("${_HEADER}.bss" 48 _HEADER)
+message("Static RAM usage (${MAP_FILE}):")
+message("${_HEADER}total")
+foreach(_LINE ${_LINES})
+    string(SUBSTRING "${_LINE}" 6 -1 _LINE)
+    message("${_LINE}")
+endforeach()
+string_padding("Total" 32 _FOOTER)
+string_padding("${_FOOTER}${_TOTAL_DATA}" 40 _FOOTER)
+string_padding("${_FOOTER}${_TOTAL_BSS}" 48 _FOOTER)
+message("${_FOOTER}${_TOTAL}")
@@ -60,3 +60,12 @@ function(target_add_git_version_header _TARGET)
     target_sources(${_TARGET} PRIVATE ${CMAKE_BINARY_DIR}/git-version.h)
     add_dependencies(${_TARGET} git-version)
 endfunction()
+
+# Print static RAM usage per module after linking an AVR executable
+function(target_add_ram_report _TARGET _MAP_FILE)
+    add_custom_command(TARGET ${_TARGET} POST_BUILD
+        COMMAND ${CMAKE_COMMAND} -DMAP_FILE=${_MAP_FILE}
+            -P ${CMAKE_SOURCE_DIR}/cmake/modules/RamReport.cmake
+        COMMENT "Reporting static RAM usage"
+    )
+endfunction()
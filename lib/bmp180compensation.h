@@ -0,0 +1,249 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#pragma once
+
+/*!
+ * \defgroup libsensors_bmp180compensation BMP180 compensation
+ * \ingroup libsensors
+ *
+ * \brief Sensors::Bmp180Compensation calculates temperature and pressure
+ *        from raw Bosch BMP180 measurements.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_bmp180compensation
+ * \copydoc libsensors_bmp180compensation
+ */
+
+#include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
+
+#include "fixedpoint.h"
+#include "utils.h"
+
+namespace Sensors
+{
+
+/*!
+ * \addtogroup libsensors_bmp180compensation
+ * \{
+ */
+
+/*! \cond */
+namespace internal
+{
+// Series expansions for evaluating the barometric formula at compile time
+// (the math functions of the standard library are not constexpr).
+constexpr double lnSeries(double y, double term, uint8_t n)
+{
+    return n > 40 ? 0.0 :
+            term / (2 * n + 1) + lnSeries(y, term * y * y, n + 1);
+}
+
+constexpr double ln(double x)
+{
+    return 2.0 * lnSeries((x - 1.0) / (x + 1.0), (x - 1.0) / (x + 1.0), 0);
+}
+
+constexpr double expSeries(double x, double term, uint8_t n)
+{
+    return n > 30 ? 0.0 : term + expSeries(x, term * x / (n + 1), n + 1);
+}
+
+constexpr double exp(double x)
+{
+    return expSeries(x, 1.0, 0);
+}
+}  // namespace internal
+/*! \endcond */
+
+/*!
+ * \brief Calculates temperature and pressure from raw Bosch BMP180
+ *        measurements.
+ *
+ * Implements the integer algorithm from the BMP180 datasheet. This is
+ * significantly faster on AVR than evaluating the equivalent polynomials
+ * with floating point math and doesn't require the floating point library.
+ *
+ * Usage:
+ * \code
+ * Sensors::Bmp180Compensation compensation;
+ * compensation.setCalibration(eeprom);  // 22 bytes read from 0xAA
+ * compensation.calculate(ut, up, oss);
+ * auto pressure = compensation.pressureAtSeaLevel(
+ *                     Sensors::Bmp180Compensation::seaLevelFactor<470>());
+ * \endcode
+ *
+ * \sa http://ae-bst.resource.bosch.com/media/products/dokumente/bmp180/BST-BMP180-DS000-12~1.pdf
+ */
+class Bmp180Compensation
+{
+public:
+    /*!
+     * \brief Fixed point type used for the sea level reduction factor.
+     */
+    using Factor = FixedPoint<4>;
+
+    /*!
+     * \brief Size of the calibration data in the sensor's EEPROM (in bytes).
+     */
+    static const uint8_t c_calibrationSize = 22;
+
+    /*!
+     * \brief Sets the calibration coefficients.
+     *
+     * \param data The #c_calibrationSize bytes read from the sensor's EEPROM
+     *        (starting at register `0xAA`, big endian).
+     */
+    void setCalibration(const uint8_t *data)
+    {
+        m_ac1 = Sensors::word(data[0], data[1]);
+        m_ac2 = Sensors::word(data[2], data[3]);
+        m_ac3 = Sensors::word(data[4], data[5]);
+        m_ac4 = Sensors::word(data[6], data[7]);
+        m_ac5 = Sensors::word(data[8], data[9]);
+        m_ac6 = Sensors::word(data[10], data[11]);
+        m_b1 = Sensors::word(data[12], data[13]);
+        m_b2 = Sensors::word(data[14], data[15]);
+        // MB (data[16], data[17]) is not used by the algorithm
+        m_mc = Sensors::word(data[18], data[19]);
+        m_md = Sensors::word(data[20], data[21]);
+    }
+
+    /*!
+     * \brief Calculates temperature and pressure from the raw values.
+     *
+     * \param ut The uncompensated temperature (registers `0xF6`, `0xF7`).
+     * \param up The uncompensated 24 bit pressure (registers `0xF6` -
+     *        `0xF8`) as read from the sensor (not yet shifted by the
+     *        oversampling setting).
+     * \param oss The oversampling setting (`0` - `3`) used for the pressure
+     *        measurement.
+     */
+    void calculate(uint16_t ut, uint32_t up, uint8_t oss)
+    {
+        // Temperature
+        int32_t x1 = ((static_cast<int32_t>(ut) - m_ac6) *
+                      static_cast<int32_t>(m_ac5)) >> 15;
+        int32_t x2 = (static_cast<int32_t>(m_mc) << 11) / (x1 + m_md);
+        int32_t b5 = x1 + x2;
+        m_temperature = (b5 + 8) >> 4;
+
+        // Pressure
+        up >>= 8 - oss;
+        int32_t b6 = b5 - 4000;
+        int32_t b6Squared = (b6 * b6) >> 12;
+        x1 = (m_b2 * b6Squared) >> 11;
+        x2 = (m_ac2 * b6) >> 11;
+        int32_t x3 = x1 + x2;
+        int32_t b3 = (((static_cast<int32_t>(m_ac1) * 4 + x3) << oss) + 2)
+                     >> 2;
+        x1 = (m_ac3 * b6) >> 13;
+        x2 = (m_b1 * b6Squared) >> 16;
+        x3 = ((x1 + x2) + 2) >> 2;
+        uint32_t b4 = (m_ac4 * static_cast<uint32_t>(x3 + 32768)) >> 15;
+        uint32_t b7 = (up - b3) * (50000UL >> oss);
+        int32_t p = b7 < 0x80000000UL ? (b7 << 1) / b4 : (b7 / b4) << 1;
+        x1 = (p >> 8) * (p >> 8);
+        x1 = (x1 * 3038) >> 16;
+        x2 = (-7357 * p) >> 16;
+        m_pressure = p + ((x1 + x2 + 3791) >> 4);
+    }
+
+    /*!
+     * \brief Returns the temperature calculated by calculate().
+     *
+     * \return The temperature in °C (resolution 0.1 °C).
+     */
+    SensorValue temperature() const
+    {
+        return SensorValue::fromRaw(m_temperature * 10);
+    }
+
+    /*!
+     * \brief Returns the absolute pressure calculated by calculate().
+     *
+     * \return The absolute pressure in hPa.
+     */
+    SensorValue pressure() const
+    {
+        static_assert(SensorValue::scale() == 100,
+                      "Pressure in Pa is the raw value in hPa.");
+        return SensorValue::fromRaw(m_pressure);
+    }
+
+    /*!
+     * \brief Returns the pressure reduced to sea level.
+     *
+     * \param factor The reduction factor for the altitude of the sensor (see
+     *        seaLevelFactor()).
+     * \return The pressure relative to sea level in hPa.
+     */
+    SensorValue pressureAtSeaLevel(Factor factor) const
+    {
+        return pressure() * factor;
+    }
+
+    /*!
+     * \brief Calculates the sea level reduction factor
+     *        `1 / (1 - altitude / 44330) ^ 5.255` for the given \p altitude.
+     *
+     * The calculation is expensive and should be done only once per
+     * altitude. Prefer seaLevelFactor<TAltitude>() for constant altitudes.
+     *
+     * \param altitude The altitude in meters.
+     * \return The raw representation of the Factor.
+     */
+    static constexpr int32_t seaLevelFactorRaw(int16_t altitude)
+    {
+        return static_cast<int32_t>(
+                    internal::exp(-5.255 * internal::ln(
+                                      1.0 - altitude / 44330.0)) *
+                    Factor::scale() + 0.5);
+    }
+
+    /*!
+     * \brief Returns the sea level reduction factor for the constant
+     *        altitude \p TAltitude (calculated at compile time).
+     *
+     * \tparam TAltitude The altitude in meters.
+     * \return The sea level reduction factor.
+     */
+    template <int16_t TAltitude>
+    static Factor seaLevelFactor()
+    {
+        static_assert(TAltitude >= -500 && TAltitude <= 9000,
+                      "Altitude out of range.");
+        static constexpr int32_t c_raw = seaLevelFactorRaw(TAltitude);
+        return Factor::fromRaw(c_raw);
+    }
+
+private:
+    int16_t m_ac1 = 0, m_ac2 = 0, m_ac3 = 0;
+    uint16_t m_ac4 = 0, m_ac5 = 0, m_ac6 = 0;
+    int16_t m_b1 = 0, m_b2 = 0, m_mc = 0, m_md = 0;
+
+    int16_t m_temperature = 0;  // 0.1 °C
+    int32_t m_pressure = 0;     // Pa
+};
+
+/*! \} */  // \addtogroup libsensors_bmp180compensation
+
+}  // namespace Sensors
@@ -0,0 +1,120 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#pragma once
+
+/*!
+ * \defgroup libsensors_cobs COBS
+ * \ingroup libsensors
+ *
+ * \brief Consistent Overhead Byte Stuffing (COBS) for framing binary data.
+ *
+ * COBS removes all `0x00` bytes from a message at the cost of at most one
+ * byte per 254 bytes. A `0x00` byte can then be used as frame delimiter,
+ * which allows the receiver to resynchronize at the next delimiter after
+ * transmission errors.
+ *
+ * \sa http://www.stuartcheshire.org/papers/COBSforToN.pdf
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_cobs
+ * \copydoc libsensors_cobs
+ */
+
+#include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
+
+namespace Sensors
+{
+
+/*!
+ * \addtogroup libsensors_cobs
+ * \{
+ */
+
+/*!
+ * \brief COBS encodes \p length bytes from \p data into the \p sink.
+ *
+ * The frame delimiter is not written.
+ *
+ * \tparam TSink Sink the encoded bytes are written into. Has to provide a
+ *         method `write(char)`.
+ * \param data The data to encode.
+ * \param length The number of bytes to encode.
+ * \param sink The sink the encoded bytes are written into.
+ */
+template <typename TSink>
+void cobsEncode(const uint8_t *data, uint16_t length, TSink &sink)
+{
+    uint16_t blockStart = 0;
+    while (blockStart <= length) {
+        // A block ends at the next zero byte or after 254 non-zero bytes
+        uint16_t blockEnd = blockStart;
+        while (blockEnd < length && data[blockEnd] != 0 &&
+               blockEnd - blockStart < 254) {
+            ++blockEnd;
+        }
+
+        sink.write(static_cast<char>(blockEnd - blockStart + 1));
+        for (uint16_t i = blockStart; i < blockEnd; ++i) {
+            sink.write(static_cast<char>(data[i]));
+        }
+
+        if (blockEnd - blockStart == 254 && blockEnd < length) {
+            blockStart = blockEnd;  // Block without implicit zero
+        } else {
+            blockStart = blockEnd + 1;
+        }
+    }
+}
+
+/*!
+ * \brief Decodes the COBS encoded \p data (without frame delimiter).
+ *
+ * The data can be decoded in place (\p output equal to \p data).
+ *
+ * \param data The encoded data.
+ * \param length The number of encoded bytes.
+ * \param output Memory location the decoded bytes are written into. Needs
+ *        space for \p length bytes.
+ * \return The number of decoded bytes or `-1` if \p data is not valid COBS.
+ */
+inline int16_t cobsDecode(const uint8_t *data, uint16_t length,
+                          uint8_t *output)
+{
+    uint16_t in = 0;
+    uint16_t out = 0;
+    while (in < length) {
+        uint8_t code = data[in++];
+        if (code == 0 || in + code - 1 > length)
+            return -1;
+
+        for (uint8_t i = 1; i < code; ++i) {
+            output[out++] = data[in++];
+        }
+        if (code < 0xFF && in < length)
+            output[out++] = 0;
+    }
+    return out;
+}
+
+/*! \} */  // \addtogroup libsensors_cobs
+
+}  // namespace Sensors
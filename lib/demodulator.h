@@ -93,6 +93,35 @@ struct BiphaseMark
                   "TLongMin must be less or equal than TLongMax");
 };
 
+/*!
+ * \brief Configuration parameter for Demodulator that enables Pulse Width
+ *        demodulation.
+ *
+ * Every pulse represents one bit. Short pulses are decoded as bit value 0,
+ * long pulses as bit value 1.
+ *
+ * \tparam TZeroMin The minimum width of a pulse recognized as bit value 0.
+ * \tparam TZeroMax The maximum width of a pulse recognized as bit value 0.
+ *                  (\p TZeroMin <= \p TZeroMax)
+ * \tparam TOneMin The minimum width of a pulse recognized as bit value 1.
+ *                 (\p TZeroMax <= \p TOneMin)
+ * \tparam TOneMax The maximum width of a pulse recognized as bit value 1.
+ *                 (\p TOneMin <= \p TOneMax)
+ *
+ * \sa https://en.wikipedia.org/wiki/Pulse-width_modulation
+ */
+template <uint16_t TZeroMin, uint16_t TZeroMax,
+          uint16_t TOneMin, uint16_t TOneMax>
+struct PulseWidth
+{
+    static_assert(TZeroMin <= TZeroMax,
+                  "TZeroMin must be less or equal than TZeroMax");
+    static_assert(TZeroMax <= TOneMin,
+                  "TZeroMax must be less or equal than TOneMin");
+    static_assert(TOneMin <= TOneMax,
+                  "TOneMin must be less or equal than TOneMax");
+};
+
 /*!
  * \brief Demodulator base implementation.
  *
@@ -169,8 +198,8 @@ protected:
  * }
  * \endcode
  *
- * \tparam TDemodulatorType The demodulation algorithm to apply (for example
- *         BiphaseMark).
+ * \tparam TDemodulatorType The demodulation algorithm to apply (BiphaseMark,
+ *         PulseWidth).
  *
  * \sa DemodulatorStatus
  *
@@ -240,6 +269,33 @@ private:
     bool m_expectShort;
 };
 
+template <
+        uint16_t TZeroMin, uint16_t TZeroMax,
+        uint16_t TOneMin, uint16_t TOneMax>
+class Demodulator<PulseWidth<TZeroMin, TZeroMax, TOneMin, TOneMax>>
+        : public DemodulatorBase<Demodulator<
+                        PulseWidth<TZeroMin, TZeroMax, TOneMin, TOneMax>>>
+{
+    friend class DemodulatorBase<Demodulator<PulseWidth<
+                                    TZeroMin, TZeroMax, TOneMin, TOneMax>>>;
+
+    DemodulatorStatus internalAddPulseWidth(uint16_t pulseWidth)
+    {
+        if (pulseWidth >= TOneMin && pulseWidth < TOneMax) {
+            this->m_data = true;
+        } else if (pulseWidth >= TZeroMin && pulseWidth < TZeroMax) {
+            this->m_data = false;
+        } else {
+            return DemodulatorStatus::OutOfRangeError;
+        }
+        return DemodulatorStatus::Complete;
+    }
+
+    void internalReset()
+    {
+    }
+};
+
 /*! \} */  // \addtogroup libsensors_demodulator
 
 }  // namespace Sensors
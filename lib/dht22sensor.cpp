@@ -0,0 +1,91 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "dht22sensor.h"
+
+#include <string.h>  // AVR toolchain doesn't offer cstring header
+
+#include "utils.h"
+
+namespace Sensors
+{
+
+Dht22Sensor::Dht22Sensor()
+{
+    reset();
+}
+
+SensorStatus Dht22Sensor::internalSetData(uint8_t *data, size_t length)
+{
+    reset();
+
+    if (length > c_length) {
+        return SensorStatus::TooMuchData;
+    }
+
+    memcpy(m_data, data, length);
+    m_byteIndex = length;
+    return status();
+}
+
+SensorStatus Dht22Sensor::internalAddByte(uint8_t byte)
+{
+    if (m_byteIndex >= c_length) {
+        return SensorStatus::TooMuchData;
+    }
+
+    m_data[m_byteIndex++] = byte;
+    return status();
+}
+
+void Dht22Sensor::internalReset()
+{
+    m_byteIndex = 0;
+    memset(m_data, 0, sizeof(m_data));
+}
+
+SensorStatus Dht22Sensor::status() const
+{
+    if (m_byteIndex < c_length) {
+        return SensorStatus::Incomplete;
+    }
+    return isValid() ? SensorStatus::Complete : SensorStatus::InvalidData;
+}
+
+bool Dht22Sensor::isValid() const
+{
+    return m_byteIndex == c_length &&
+           (uint8_t)(m_data[0] + m_data[1] + m_data[2] + m_data[3]) ==
+           m_data[4];
+}
+
+SensorValue Dht22Sensor::temperature() const
+{
+    SensorValue temperature = SensorValue::fromRaw(
+                word(m_data[2] & 0x7F, m_data[3]) * c_decimalScale);
+    return bitRead(m_data[2], 7) ? -temperature : temperature;
+}
+
+SensorValue Dht22Sensor::humidity() const
+{
+    return SensorValue::fromRaw(
+                word(m_data[0], m_data[1]) * c_decimalScale);
+}
+
+}  // namespace Sensors
@@ -0,0 +1,161 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#pragma once
+
+/*!
+ * \defgroup libsensors_dht22 DHT22 Temperature / Humidity
+ * \ingroup libsensors
+ *
+ * \brief Sensors::Dht22Sensor and Sensors::Dht22Device decode data from
+ *        DHT22 / AM2302 Temperature and Humidity sensors.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_dht22
+ * \copydoc libsensors_dht22
+ */
+
+#include <stdlib.h>  // AVR toolchain doesn't offer cstdlib header
+
+#include "fixedpoint.h"
+#include "sensor.h"
+#include "demodulator.h"
+#include "bitdecoder.h"
+#include "rfdevice.h"
+
+namespace Sensors
+{
+
+/*!
+ * \addtogroup libsensors_dht22
+ * \{
+ */
+
+/*!
+ * \brief Decodes data received from a DHT22 / AM2302 sensor.
+ *
+ * A message consists of 5 bytes: humidity (in 1/10 %, 2 bytes), temperature
+ * (in 1/10 °C, 2 bytes, the most significant bit indicates negative
+ * temperatures) and a checksum (sum of the 4 data bytes).
+ *
+ * \sa http://akizukidenshi.com/download/ds/aosong/AM2302.pdf
+ */
+class Dht22Sensor : public Sensor<Dht22Sensor>
+{
+    friend class Sensor<Dht22Sensor>;
+
+public:
+    /*!
+     * \brief Initializes the DHT22 sensor decoder.
+     */
+    Dht22Sensor();
+
+    /*!
+     * \brief Determines if the current decoder state is valid.
+     *
+     * \return `true` if a complete message with valid checksum has been
+     *         received, `false` otherwise.
+     */
+    bool isValid() const;
+
+    /*!
+     * \brief Gets the temperature value of the current message.
+     *
+     * \return The temperature value of the current message.
+     */
+    SensorValue temperature() const;
+
+    /*!
+     * \brief Gets the humidity value of the current message.
+     *
+     * \return The humidity value of the current message.
+     */
+    SensorValue humidity() const;
+
+private:
+    SensorStatus internalSetData(uint8_t *data, size_t length);
+    SensorStatus internalAddByte(uint8_t byte);
+    void internalReset();
+
+    /*!
+     * \brief Returns the status after adding bytes to the current message.
+     *
+     * \return The status of the current message.
+     */
+    SensorStatus status() const;
+
+    /*!
+     * \brief A message transmitted by a DHT22 sensor has a constant size of
+     *        5 bytes.
+     */
+    static const size_t c_length = 5;
+
+    /*!
+     * \brief Temperature and humidity are transmitted in 1/10 °C and 1/10 %.
+     */
+    static const uint8_t c_decimalScale = SensorValue::scale() / 10;
+
+    /*!
+     * \brief The current state of the DHT22 sensor decoder.
+     */
+    uint8_t m_data[c_length];
+
+    /*!
+     * \brief The number of bytes added to the current state of the DHT22
+     *        sensor decoder.
+     */
+    uint8_t m_byteIndex;
+};
+
+/*!
+ * \brief DHT22 sensor device implemented using a Sensors::Dht22Sensor with
+ *        the DHT22 single-bus reception parameters.
+ *
+ * A DHT22 transmits 40 bits with MSB bit numbering and without parity. The
+ * value of a bit is signaled by the width of the high pulse following each
+ * low pulse (T_LOW): short (T_H0: min 22 us, typ 26 us, max 30 us) or long
+ * (T_H1: min 68 us, typ 70 us, max 75 us). Only the widths of these high
+ * pulses (without the acknowledgement pulses) have to be added.
+ *
+ * \tparam TZeroMin Minimum length of a 0 bit. Should be set to 10 us.
+ * \tparam TZeroMax Maximum length of a 0 bit. Should be set to 48 us.
+ * \tparam TOneMin Minimum length of a 1 bit. Should be set to 48 us.
+ * \tparam TOneMax Maximum length of a 1 bit. Should be set to 100 us.
+ * \tparam TStatistics The statistics configuration (see
+ *         NoRfDeviceStatistics and RfDeviceStatistics).
+ *
+ * \note The parameters \p TZeroMin, \p TZeroMax, \p TOneMin and \p TOneMax
+ *       have to be set to the system tick values representing the time
+ *       (in us) documented above.
+ */
+template <uint16_t TZeroMin, uint16_t TZeroMax,
+          uint16_t TOneMin, uint16_t TOneMax,
+          typename TStatistics = NoRfDeviceStatistics>
+using Dht22Device = RfDevice<
+    Demodulator<PulseWidth<TZeroMin, TZeroMax, TOneMin, TOneMax>>,
+    ByteDecoder<NoParity, MsbBitNumbering>,
+    Dht22Sensor,
+    40,
+    TStatistics>;
+
+/*! \} */  // \addtogroup libsensors_dht22
+
+}  // namespace Sensors
@@ -0,0 +1,419 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#pragma once
+
+/*!
+ * \defgroup libsensors_fixedpoint Fixed point
+ * \ingroup libsensors
+ *
+ * \brief Sensors::FixedPoint is a decimal fixed point number type for sensor
+ *        values that avoids (soft) floating point arithmetic.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_fixedpoint
+ * \copydoc libsensors_fixedpoint
+ */
+
+#include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
+
+namespace Sensors
+{
+
+/*!
+ * \addtogroup libsensors_fixedpoint
+ * \{
+ */
+
+/*!
+ * \brief Signed decimal fixed point number with \p TDigits fractional
+ *        digits.
+ *
+ * The value is stored as 32 bit integer scaled by `10^TDigits`. All
+ * arithmetic operations saturate at max() and min() instead of overflowing
+ * and use 32 bit integer operations only. Values can be converted into their
+ * exact decimal representation with format().
+ *
+ * Usage:
+ * \code
+ * auto temperature = Sensors::FixedPoint<2>::fromRaw(2480);  // 24.80
+ * temperature += 1;                                          // 25.80
+ *
+ * char str[Sensors::FixedPoint<2>::formatSize()];
+ * temperature.format(str, sizeof(str));                      // "25.80"
+ * \endcode
+ *
+ * \tparam TDigits Number of fractional decimal digits (`0`-`4`).
+ */
+template <uint8_t TDigits>
+class FixedPoint
+{
+    static_assert(TDigits <= 4, "TDigits must not exceed 4 digits");
+
+public:
+    /*!
+     * \brief Returns the factor the raw value is scaled with.
+     *
+     * \return The scale factor (`10^TDigits`).
+     */
+    static constexpr int32_t scale()
+    {
+        return pow10(TDigits);
+    }
+
+    /*!
+     * \brief Returns the buffer size required by format() for any value
+     *        (including the terminating null character).
+     *
+     * \return The required buffer size.
+     */
+    static constexpr uint8_t formatSize()
+    {
+        return 13;  // Sign, 10 digits, decimal point, null character
+    }
+
+    /*!
+     * \brief Constructs the value `0`.
+     */
+    constexpr FixedPoint()
+        : m_raw(0)
+    {
+    }
+
+    /*!
+     * \brief Constructs the fixed point number from the given \p integer.
+     *
+     * \param integer Integral value (saturated if out of range).
+     */
+    FixedPoint(int32_t integer)
+        : m_raw(saturate(
+              saturatedMultiply(magnitude(integer), scale(), c_max),
+              integer < 0))
+    {
+    }
+
+    /*!
+     * \brief Constructs the fixed point number from its \p raw
+     *        representation.
+     *
+     * \param raw The value multiplied by scale() (e.g. `2480` for `24.80`
+     *        with 2 digits).
+     * \return The fixed point number.
+     */
+    static FixedPoint fromRaw(int32_t raw)
+    {
+        FixedPoint value;
+        value.m_raw = raw < -c_max ? -c_max : raw;
+        return value;
+    }
+
+    /*!
+     * \brief Constructs the fixed point number from the quotient of
+     *        \p numerator and \p denominator.
+     *
+     * The result is truncated. Denominators larger than `UINT32_MAX / 10`
+     * lose precision in the least significant bits.
+     *
+     * \param numerator The dividend.
+     * \param denominator The divisor.
+     * \return The quotient or max() if \p denominator is `0`.
+     */
+    static FixedPoint fromRatio(uint32_t numerator, uint32_t denominator)
+    {
+        if (denominator == 0)
+            return max();
+
+        while (denominator > UINT32_MAX / 10) {
+            numerator >>= 1;
+            denominator >>= 1;
+        }
+
+        uint32_t remainder = numerator % denominator;
+        uint32_t fraction = 0;
+        for (uint8_t digit = 0; digit < TDigits; ++digit) {
+            remainder *= 10;
+            fraction = fraction * 10 + remainder / denominator;
+            remainder %= denominator;
+        }
+        return fromRaw(saturatedAdd(
+            saturatedMultiply(numerator / denominator, scale(), c_max),
+            fraction, c_max));
+    }
+
+    /*!
+     * \brief Returns the largest representable value.
+     *
+     * \return The largest representable value.
+     */
+    static FixedPoint max()
+    {
+        return fromRaw(c_max);
+    }
+
+    /*!
+     * \brief Returns the smallest representable value.
+     *
+     * \return The smallest representable value (`-max()`).
+     */
+    static FixedPoint min()
+    {
+        return fromRaw(-c_max);
+    }
+
+    /*!
+     * \brief Returns the raw representation.
+     *
+     * \return The value multiplied by scale().
+     */
+    int32_t raw() const
+    {
+        return m_raw;
+    }
+
+    /*!
+     * \brief Returns the integral part (truncated towards zero).
+     *
+     * \return The integral part.
+     */
+    int32_t integer() const
+    {
+        return m_raw / scale();
+    }
+
+    /*!
+     * \brief Multiplies the unsigned integer \p value with this number.
+     *
+     * Can be used to apply a correction factor to a large integral value.
+     *
+     * \param value The integral value.
+     * \return The product (truncated and saturated at `UINT32_MAX`). `0` if
+     *         this number is negative.
+     */
+    uint32_t multiply(uint32_t value) const
+    {
+        if (m_raw < 0)
+            return 0;
+        return multiplyScaled(value, m_raw, scale(), false, UINT32_MAX);
+    }
+
+    /*!
+     * \brief Formats the exact decimal representation of the number into
+     *        the given \p buffer.
+     *
+     * The representation contains all \p TDigits fractional digits
+     * (e.g. `"-1.50"`).
+     *
+     * \param buffer Memory location the string is written into.
+     * \param size Size of the \p buffer. formatSize() is sufficient for any
+     *        value.
+     * \return The length of the string (without the terminating null
+     *         character) or `0` if the \p buffer is too small. In that case
+     *         the \p buffer contains an empty string.
+     */
+    uint8_t format(char *buffer, uint8_t size) const
+    {
+        // Generate digits in reverse order
+        char reversed[formatSize()];
+        uint8_t length = 0;
+        uint32_t value = magnitude(m_raw);
+        for (uint8_t digit = 0; digit < TDigits; ++digit) {
+            reversed[length++] = '0' + value % 10;
+            value /= 10;
+        }
+        if (TDigits > 0)
+            reversed[length++] = '.';
+        do {
+            reversed[length++] = '0' + value % 10;
+            value /= 10;
+        } while (value > 0);
+        if (m_raw < 0)
+            reversed[length++] = '-';
+
+        if (length >= size) {
+            if (size > 0)
+                buffer[0] = '\0';
+            return 0;
+        }
+        for (uint8_t i = 0; i < length; ++i) {
+            buffer[i] = reversed[length - 1 - i];
+        }
+        buffer[length] = '\0';
+        return length;
+    }
+
+    /*!
+     * \name Arithmetic operators
+     *
+     * All operators saturate at max() and min().
+     *
+     * \{
+     */
+
+    FixedPoint operator-() const
+    {
+        return fromRaw(-m_raw);
+    }
+
+    FixedPoint &operator+=(const FixedPoint &other)
+    {
+        if (other.m_raw > 0 && m_raw > c_max - other.m_raw) {
+            m_raw = c_max;
+        } else if (other.m_raw < 0 && m_raw < -c_max - other.m_raw) {
+            m_raw = -c_max;
+        } else {
+            m_raw += other.m_raw;
+        }
+        return *this;
+    }
+
+    FixedPoint &operator-=(const FixedPoint &other)
+    {
+        return *this += -other;
+    }
+
+    /*!
+     * \brief Multiplies with a fixed point number of arbitrary precision.
+     *
+     * The result is rounded to \p TDigits digits.
+     */
+    template <uint8_t TOtherDigits>
+    FixedPoint &operator*=(const FixedPoint<TOtherDigits> &other)
+    {
+        m_raw = saturate(multiplyScaled(magnitude(m_raw),
+                                        magnitude(other.raw()),
+                                        FixedPoint<TOtherDigits>::scale(),
+                                        true, c_max),
+                         (m_raw < 0) != (other.raw() < 0));
+        return *this;
+    }
+
+    FixedPoint operator+(const FixedPoint &other) const
+    {
+        return FixedPoint(*this) += other;
+    }
+
+    FixedPoint operator-(const FixedPoint &other) const
+    {
+        return FixedPoint(*this) -= other;
+    }
+
+    template <uint8_t TOtherDigits>
+    FixedPoint operator*(const FixedPoint<TOtherDigits> &other) const
+    {
+        return FixedPoint(*this) *= other;
+    }
+
+    /*! \} */  // Arithmetic operators
+
+    /*!
+     * \name Comparison operators
+     * \{
+     */
+
+    bool operator==(const FixedPoint &other) const
+    {
+        return m_raw == other.m_raw;
+    }
+
+    bool operator!=(const FixedPoint &other) const
+    {
+        return m_raw != other.m_raw;
+    }
+
+    bool operator<(const FixedPoint &other) const
+    {
+        return m_raw < other.m_raw;
+    }
+
+    bool operator<=(const FixedPoint &other) const
+    {
+        return m_raw <= other.m_raw;
+    }
+
+    bool operator>(const FixedPoint &other) const
+    {
+        return m_raw > other.m_raw;
+    }
+
+    bool operator>=(const FixedPoint &other) const
+    {
+        return m_raw >= other.m_raw;
+    }
+
+    /*! \} */  // Comparison operators
+
+private:
+    // Symmetric range so that negation cannot overflow.
+    static const int32_t c_max = INT32_MAX;
+
+    static constexpr int32_t pow10(uint8_t exponent)
+    {
+        return exponent == 0 ? 1 : 10 * pow10(exponent - 1);
+    }
+
+    static uint32_t magnitude(int32_t value)
+    {
+        return value < 0 ? 0U - static_cast<uint32_t>(value) : value;
+    }
+
+    static int32_t saturate(uint32_t magnitude, bool negative)
+    {
+        int32_t value = magnitude > static_cast<uint32_t>(c_max) ?
+                    c_max : static_cast<int32_t>(magnitude);
+        return negative ? -value : value;
+    }
+
+    static uint32_t saturatedAdd(uint32_t a, uint32_t b, uint32_t limit)
+    {
+        return a > limit - b ? limit : a + b;
+    }
+
+    static uint32_t saturatedMultiply(uint32_t a, uint32_t b, uint32_t limit)
+    {
+        return (b != 0 && a > limit / b) ? limit : a * b;
+    }
+
+    // Calculates a * b / divisor without requiring 64 bit arithmetic by
+    // splitting both factors into quotient and remainder of the divisor.
+    // The divisor must not exceed 16 bit.
+    static uint32_t multiplyScaled(uint32_t a, uint32_t b, uint32_t divisor,
+                                   bool round, uint32_t limit)
+    {
+        uint32_t result = saturatedMultiply(a, b / divisor, limit);
+        result = saturatedAdd(
+            result, saturatedMultiply(a / divisor, b % divisor, limit), limit);
+        uint32_t remainder = (a % divisor) * (b % divisor);
+        if (round)
+            remainder += divisor / 2;
+        return saturatedAdd(result, remainder / divisor, limit);
+    }
+
+    int32_t m_raw;
+};
+
+/*!
+ * \brief Fixed point type used for sensor values (2 fractional digits).
+ */
+using SensorValue = FixedPoint<2>;
+
+/*! \} */  // \addtogroup libsensors_fixedpoint
+
+}  // namespace Sensors
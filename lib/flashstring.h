@@ -0,0 +1,150 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#pragma once
+
+/*!
+ * \defgroup libsensors_flashstring Flash string
+ * \ingroup libsensors
+ *
+ * \brief Sensors::FlashString refers to constant strings that are kept in
+ *        the AVR's program memory (flash) instead of SRAM.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_flashstring
+ * \copydoc libsensors_flashstring
+ */
+
+#include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
+#include <string.h>    // AVR toolchain doesn't offer cstring header
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#endif
+
+namespace Sensors
+{
+
+/*!
+ * \addtogroup libsensors_flashstring
+ * \{
+ */
+
+/*!
+ * \brief A null-terminated string located in program memory.
+ *
+ * On AVR, strings in program memory have to be read with `pgm_read_byte`.
+ * On other platforms (host based unit tests) the string is accessed directly.
+ *
+ * Usage:
+ * \code
+ * Sensors::FlashString str = FLASH_STRING("temperature");
+ * for (uint16_t i = 0; str[i] != '\0'; ++i) {
+ *     // ...
+ * }
+ * \endcode
+ *
+ * \sa FLASH_STRING
+ */
+class FlashString
+{
+public:
+    /*!
+     * \brief Refers to the string \p str in program memory.
+     *
+     * \param str Null-terminated string in program memory (`PROGMEM`).
+     */
+    constexpr explicit FlashString(const char *str)
+        : m_str(str)
+    {
+    }
+
+    /*!
+     * \brief Reads the character at \p index from program memory.
+     *
+     * \param index Position of the character within the string.
+     * \return The character at \p index.
+     */
+    char operator[](uint16_t index) const
+    {
+#ifdef __AVR__
+        return pgm_read_byte(m_str + index);
+#else
+        return m_str[index];
+#endif
+    }
+
+    /*!
+     * \brief Returns the length of the string.
+     *
+     * \return The number of characters (without the null terminator).
+     */
+    uint16_t length() const
+    {
+#ifdef __AVR__
+        return strlen_P(m_str);
+#else
+        return strlen(m_str);
+#endif
+    }
+
+    /*!
+     * \brief Copies \p length characters starting at \p index from program
+     *        memory to \p dest.
+     *
+     * Allows processing long strings in small chunks without keeping a copy
+     * of the whole string in SRAM.
+     *
+     * \param index Position of the first character within the string.
+     * \param length The number of characters to copy.
+     * \param dest Memory location the characters are copied to (not
+     *        null-terminated).
+     */
+    void copy(uint16_t index, uint16_t length, char *dest) const
+    {
+#ifdef __AVR__
+        memcpy_P(dest, m_str + index, length);
+#else
+        memcpy(dest, m_str + index, length);
+#endif
+    }
+
+private:
+    const char *m_str;
+};
+
+/*! \} */  // \addtogroup libsensors_flashstring
+
+}  // namespace Sensors
+
+/*!
+ * \brief Places the string literal \p str in program memory and returns a
+ *        Sensors::FlashString referring to it.
+ *
+ * Can only be used within functions.
+ *
+ * \ingroup libsensors_flashstring
+ */
+#ifdef __AVR__
+#define FLASH_STRING(str) (::Sensors::FlashString(PSTR(str)))
+#else
+#define FLASH_STRING(str) (::Sensors::FlashString(str))
+#endif
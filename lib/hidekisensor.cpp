@@ -167,14 +167,7 @@ uint8_t HidekiSensor::crc2() const
 {
     uint8_t crc2 = 0;
     for (uint8_t byte = 1; byte < packageLength() + 2; ++byte) {
-        crc2 = crc2 ^ m_data[byte];
-        for (uint8_t bit = 0; bit < 8; ++bit) {
-            if ((crc2 & 0x01) != 0) {
-                crc2 = (crc2 >> 1) ^ 0xE0;
-            } else {
-                crc2 >>= 1;
-            }
-        }
+        crc2 = crc8Lsb(crc2, m_data[byte], 0xE0);
     }
     return crc2;
 }
@@ -194,13 +187,16 @@ int8_t HidekiSensor::temperature() const
     return temp;
 }
 
-float HidekiSensor::temperatureF() const
+SensorValue HidekiSensor::temperatureFixed() const
 {
-    float decimal = lowNibble(m_data[4]) * 0.1;
-    if (highNibble(m_data[5]) == c_thermoHygroTempNegative)
-        decimal = -decimal;
+    if (!isThermoHygro())
+        return 0;
 
-    return isThermoHygro() ? temperature() + decimal : 0;
+    int16_t temp = (lowNibble(m_data[5]) * 100 + highNibble(m_data[4]) * 10 +
+                    lowNibble(m_data[4])) * (SensorValue::scale() / 10);
+    if (highNibble(m_data[5]) == c_thermoHygroTempNegative)
+        temp = -temp;
+    return SensorValue::fromRaw(temp);
 }
 
 uint8_t HidekiSensor::humidity() const
@@ -36,6 +36,7 @@
 #include <stdlib.h>  // AVR toolchain doesn't offer cstdlib header
 #include <string.h>  // AVR toolchain doesn't offer cstring header
 
+#include "fixedpoint.h"
 #include "sensor.h"
 #include "demodulator.h"
 #include "bitdecoder.h"
@@ -155,11 +156,12 @@ public:
     int8_t temperature() const;
 
     /*!
-     * \brief Gets the temperature value of the current message as float.
+     * \brief Gets the temperature value of the current message including the
+     *        decimal place.
      *
      * \return The temperature value of the current message.
      */
-    float temperatureF() const;
+    SensorValue temperatureFixed() const;
 
     /*!
      * \brief Gets the humidity value of the current message.
@@ -275,18 +277,26 @@ private:
  * \tparam TShortMax Maximum length of a short pulse. Has to be set to 726 us.
  * \tparam TLongMin Minimum length of a long pulse. Has to be set to 726 us.
  * \tparam TLongMax Maximum length of a long pulse. Has to be set to 1464 us.
+ * \tparam TStatistics The statistics configuration (see
+ *         NoRfDeviceStatistics and RfDeviceStatistics).
+ * \tparam TState The state configuration (see RfDeviceState and
+ *         PackedRfDeviceState).
  *
  * \note The parameters \p TShortMin, \p TShortMax, \p TLongMin and
  *       \p TLongMax have to be set to the system tick values representing the
  *       time (in us) documented above.
  */
 template <uint16_t TShortMin, uint16_t TShortMax,
-          uint16_t TLongMin, uint16_t TLongMax>
+          uint16_t TLongMin, uint16_t TLongMax,
+          typename TStatistics = NoRfDeviceStatistics,
+          typename TState = RfDeviceState>
 using HidekiDevice = RfDevice<
     Demodulator<BiphaseMark<TShortMin, TShortMax, TLongMin, TLongMax>>,
     ByteDecoder<EvenParity, LsbBitNumbering>,
     HidekiSensor,
-    89>;
+    89,
+    TStatistics,
+    TState>;
 
 /*!
  * \brief Data class for storing values of a HidekiSensor.
@@ -320,7 +330,7 @@ public:
         m_channel = sensor.channel();
         m_batteryOk = sensor.batteryOk();
         m_temperature = sensor.temperature();
-        m_temperatureF = sensor.temperatureF();
+        m_temperatureFixed = sensor.temperatureFixed();
         m_humidity = sensor.humidity();
     }
 
@@ -332,7 +342,7 @@ public:
         m_channel = 0;
         m_batteryOk = false;
         m_temperature = 0;
-        m_temperatureF = 0.0;
+        m_temperatureFixed = 0;
         m_humidity = 0;
         m_valid = false;
     }
@@ -378,13 +388,13 @@ public:
     }
 
     /*!
-     * \brief Gets the temperature value as float.
+     * \brief Gets the temperature value including the decimal place.
      *
      * \return The temperature value.
      */
-    float temperatureF() const
+    SensorValue temperatureFixed() const
     {
-        return m_temperatureF;
+        return m_temperatureFixed;
     }
 
     /*!
@@ -402,7 +412,7 @@ private:
     uint8_t m_channel;
     bool m_batteryOk;
     int8_t m_temperature;
-    float m_temperatureF;
+    SensorValue m_temperatureFixed;
     uint8_t m_humidity;
 };
 
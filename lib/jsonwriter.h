@@ -0,0 +1,336 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#pragma once
+
+/*!
+ * \defgroup libsensors_jsonwriter JSON writer
+ * \ingroup libsensors
+ *
+ * \brief Sensors::JsonWriter serializes sensor values as JSON without
+ *        dynamic memory or (floating point) printf support.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_jsonwriter
+ * \copydoc libsensors_jsonwriter
+ */
+
+#include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
+
+#include "fixedpoint.h"
+#include "flashstring.h"
+
+namespace Sensors
+{
+
+/*!
+ * \addtogroup libsensors_jsonwriter
+ * \{
+ */
+
+/*!
+ * \brief Sink for Sensors::JsonWriter writing into a caller provided
+ *        character buffer.
+ *
+ * The buffer always contains a null-terminated string. Characters that don't
+ * fit into the buffer are dropped and the sink is marked as overflown.
+ */
+class BufferSink
+{
+public:
+    /*!
+     * \brief Initializes the sink with an empty string.
+     *
+     * \param buffer Memory location the characters are written into.
+     * \param size Size of the \p buffer (including the null character).
+     */
+    BufferSink(char *buffer, uint16_t size)
+        : m_buffer(buffer)
+        , m_size(size)
+    {
+        reset();
+    }
+
+    /*!
+     * \brief Appends the character \p c.
+     *
+     * \param c The character to append.
+     */
+    void write(char c)
+    {
+        if (m_length + 1U < m_size) {
+            m_buffer[m_length++] = c;
+            m_buffer[m_length] = '\0';
+        } else {
+            m_overflown = true;
+        }
+    }
+
+    /*!
+     * \brief Clears the buffer and the overflow state.
+     */
+    void reset()
+    {
+        m_length = 0;
+        m_overflown = false;
+        if (m_size > 0)
+            m_buffer[0] = '\0';
+    }
+
+    /*!
+     * \brief Returns the null-terminated string written so far.
+     *
+     * \return The string written so far.
+     */
+    const char *str() const
+    {
+        return m_buffer;
+    }
+
+    /*!
+     * \brief Returns the length of the string written so far.
+     *
+     * \return The length of the string (without the null character).
+     */
+    uint16_t length() const
+    {
+        return m_length;
+    }
+
+    /*!
+     * \brief Determines if characters had to be dropped.
+     *
+     * \return `true` if characters have been dropped since the last reset(),
+     *         `false` otherwise.
+     */
+    bool isOverflown() const
+    {
+        return m_overflown;
+    }
+
+private:
+    char *m_buffer;
+    uint16_t m_size;
+    uint16_t m_length;
+    bool m_overflown;
+};
+
+/*!
+ * \brief Streaming JSON writer.
+ *
+ * The writer emits JSON objects directly into a sink while keeping track of
+ * the separators. Keys are Sensors::FlashString instances so that they don't
+ * occupy SRAM. Numbers are formatted with integer arithmetic.
+ *
+ * Usage:
+ * \code
+ * char str[64];
+ * Sensors::BufferSink sink(str, sizeof(str));
+ * Sensors::JsonWriter<Sensors::BufferSink> json(sink);
+ * json.beginObject();
+ * json.beginObject(FLASH_STRING("dht22"));
+ * json.addValue(FLASH_STRING("temperature"), dht22.temperature());
+ * json.addValue(FLASH_STRING("humidity"), dht22.humidity());
+ * json.endObject();
+ * json.endObject();
+ * // str: {"dht22":{"temperature":24.80,"humidity":41.20}}
+ * \endcode
+ *
+ * \tparam TSink Sink the characters are written into. Has to provide a
+ *         method `write(char)`.
+ *
+ * \note The writer doesn't validate the structure. Objects have to be
+ *       closed by the caller.
+ */
+template <typename TSink>
+class JsonWriter
+{
+public:
+    /*!
+     * \brief Initializes the writer.
+     *
+     * \param sink The sink the characters are written into.
+     */
+    explicit JsonWriter(TSink &sink)
+        : m_sink(sink)
+    {
+    }
+
+    /*!
+     * \brief Begins an anonymous object (top level or within an array).
+     */
+    void beginObject()
+    {
+        writeSeparator();
+        beginObjectBody();
+    }
+
+    /*!
+     * \brief Begins an object that is a member named \p key.
+     *
+     * \param key The member name.
+     */
+    void beginObject(FlashString key)
+    {
+        writeKey(key);
+        beginObjectBody();
+    }
+
+    /*!
+     * \brief Begins an object that is a member named \p key followed by the
+     *        decimal \p index (e.g. `"rf433_1"`).
+     *
+     * \param key The member name prefix.
+     * \param index The index appended to the member name.
+     */
+    void beginObject(FlashString key, uint8_t index)
+    {
+        writeKey(key, index);
+        beginObjectBody();
+    }
+
+    /*!
+     * \brief Ends the current object.
+     */
+    void endObject()
+    {
+        m_sink.write('}');
+        m_first = false;
+    }
+
+    /*!
+     * \brief Adds a member with a signed integer \p value.
+     *
+     * \param key The member name.
+     * \param value The value.
+     */
+    void addInt(FlashString key, int32_t value)
+    {
+        writeKey(key);
+        if (value < 0)
+            m_sink.write('-');
+        writeUInt(value < 0 ? 0U - static_cast<uint32_t>(value) : value);
+    }
+
+    /*!
+     * \brief Adds a member with an unsigned integer \p value.
+     *
+     * \param key The member name.
+     * \param value The value.
+     */
+    void addUInt(FlashString key, uint32_t value)
+    {
+        writeKey(key);
+        writeUInt(value);
+    }
+
+    /*!
+     * \brief Adds a member with a boolean \p value.
+     *
+     * \param key The member name.
+     * \param value The value.
+     */
+    void addBool(FlashString key, bool value)
+    {
+        writeKey(key);
+        writeString(value ? FLASH_STRING("true") : FLASH_STRING("false"));
+    }
+
+    /*!
+     * \brief Adds a member with a fixed point \p value.
+     *
+     * The value is written with all fractional digits (e.g. `24.80`).
+     *
+     * \param key The member name.
+     * \param value The value.
+     */
+    template <uint8_t TDigits>
+    void addValue(FlashString key, FixedPoint<TDigits> value)
+    {
+        writeKey(key);
+        char str[FixedPoint<TDigits>::formatSize()];
+        value.format(str, sizeof(str));
+        for (const char *c = str; *c != '\0'; ++c) {
+            m_sink.write(*c);
+        }
+    }
+
+private:
+    void beginObjectBody()
+    {
+        m_sink.write('{');
+        m_first = true;
+    }
+
+    void writeSeparator()
+    {
+        if (!m_first)
+            m_sink.write(',');
+        m_first = false;
+    }
+
+    void writeKey(FlashString key)
+    {
+        writeSeparator();
+        m_sink.write('"');
+        writeString(key);
+        m_sink.write('"');
+        m_sink.write(':');
+    }
+
+    void writeKey(FlashString key, uint8_t index)
+    {
+        writeSeparator();
+        m_sink.write('"');
+        writeString(key);
+        writeUInt(index);
+        m_sink.write('"');
+        m_sink.write(':');
+    }
+
+    void writeString(FlashString str)
+    {
+        for (uint16_t i = 0; str[i] != '\0'; ++i) {
+            m_sink.write(str[i]);
+        }
+    }
+
+    void writeUInt(uint32_t value)
+    {
+        // Generate digits in reverse order
+        char reversed[10];
+        uint8_t length = 0;
+        do {
+            reversed[length++] = '0' + value % 10;
+            value /= 10;
+        } while (value > 0);
+        while (length > 0) {
+            m_sink.write(reversed[--length]);
+        }
+    }
+
+    TSink &m_sink;
+    bool m_first = true;
+};
+
+/*! \} */  // \addtogroup libsensors_jsonwriter
+
+}  // namespace Sensors
@@ -0,0 +1,262 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#pragma once
+
+/*!
+ * \defgroup libsensors_messagequeue Message queue
+ * \ingroup libsensors
+ *
+ * \brief Sensors::MessageQueue buffers variable length messages for an
+ *        output that is drained independently of the code producing the
+ *        messages.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_messagequeue
+ * \copydoc libsensors_messagequeue
+ */
+
+#include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
+
+namespace Sensors
+{
+
+/*!
+ * \addtogroup libsensors_messagequeue
+ * \{
+ */
+
+/*!
+ * \brief Determines which messages are dropped if a Sensors::MessageQueue
+ *        is full.
+ */
+enum class DropPolicy : uint8_t {
+    DropNewest,  //!< The new message is dropped, queued messages are kept
+    DropOldest   //!< The oldest messages are dropped to make room
+};
+
+/*!
+ * \brief Fixed size queue of variable length messages.
+ *
+ * Messages are stored back to back with a length byte in a ring buffer, so
+ * short messages only occupy the space they need. Messages are either
+ * removed as a whole with pop(uint8_t *, uint8_t) or streamed byte by byte
+ * with pop(uint8_t &). Both ways must not be mixed on the same queue.
+ *
+ * Usage:
+ * \code
+ * Sensors::MessageQueue<256> queue;
+ *
+ * void send(const uint8_t *message, uint8_t length) {
+ *     queue.push(message, length);
+ * }
+ *
+ * void drain() {
+ *     uint8_t byte;
+ *     while (canTransmit() && queue.pop(byte)) {
+ *         transmit(byte);
+ *     }
+ * }
+ * \endcode
+ *
+ * \note The queue is not synchronized, producer and consumer have to run in
+ *       the same context (e.g. both from the main loop).
+ *
+ * \tparam TSize Capacity of the queue in bytes (including one length byte
+ *         per message).
+ * \tparam TPolicy Policy for dropping messages if the queue is full.
+ *         Sensors::DropPolicy::DropOldest requires that messages are removed
+ *         as a whole.
+ */
+template <uint16_t TSize, DropPolicy TPolicy = DropPolicy::DropNewest>
+class MessageQueue
+{
+    static_assert(TSize >= 2, "TSize must hold at least one message");
+
+public:
+    /*!
+     * \brief Appends the message \p data with \p length bytes.
+     *
+     * Messages that are larger than the queue are always dropped. Empty
+     * messages are ignored.
+     *
+     * \param data The message.
+     * \param length The number of bytes of the message.
+     * \return `true` if the message has been appended, `false` if it has
+     *         been dropped.
+     */
+    bool push(const uint8_t *data, uint16_t length)
+    {
+        if (length == 0)
+            return true;
+        if (length > UINT8_MAX || length + 1 > TSize) {
+            increment(m_dropped);
+            return false;
+        }
+
+        while (TSize - m_size < length + 1) {
+            if (TPolicy == DropPolicy::DropNewest) {
+                increment(m_dropped);
+                return false;
+            }
+            skip(read());
+            increment(m_dropped);
+        }
+
+        write(length);
+        for (uint16_t i = 0; i < length; ++i) {
+            write(data[i]);
+        }
+        return true;
+    }
+
+    /*!
+     * \brief Removes the oldest message.
+     *
+     * \param data Memory location the message is stored into.
+     * \param size The size of \p data. Messages larger than \p size are
+     *        dropped.
+     * \return The length of the removed message, `0` if the queue is empty
+     *         or the message has been dropped.
+     */
+    uint8_t pop(uint8_t *data, uint8_t size)
+    {
+        if (isEmpty())
+            return 0;
+
+        uint8_t length = read();
+        if (length > size) {
+            skip(length);
+            increment(m_dropped);
+            return 0;
+        }
+        for (uint8_t i = 0; i < length; ++i) {
+            data[i] = read();
+        }
+        return length;
+    }
+
+    /*!
+     * \brief Removes the next byte of the oldest message.
+     *
+     * Messages are returned back to back without separation, the caller
+     * has to rely on the message format for framing.
+     *
+     * \param byte Memory location the byte is stored into.
+     * \return `true` if a byte has been removed, `false` if the queue is
+     *         empty.
+     */
+    bool pop(uint8_t &byte)
+    {
+        static_assert(TPolicy == DropPolicy::DropNewest,
+                      "Partially removed messages cannot be dropped");
+        if (m_remaining == 0) {
+            if (isEmpty())
+                return false;
+            m_remaining = read();
+        }
+        byte = read();
+        --m_remaining;
+        return true;
+    }
+
+    /*!
+     * \brief Determines if the queue is empty.
+     *
+     * \return `true` if the queue is empty, `false` otherwise.
+     */
+    bool isEmpty() const
+    {
+        return m_size == 0;
+    }
+
+    /*!
+     * \brief Returns the number of bytes stored in the queue (including
+     *        length bytes).
+     *
+     * \return The number of bytes stored in the queue.
+     */
+    uint16_t size() const
+    {
+        return m_size;
+    }
+
+    /*!
+     * \brief Returns the number of messages that have been dropped.
+     *
+     * The counter saturates at `UINT16_MAX`.
+     *
+     * \return The number of dropped messages.
+     */
+    uint16_t dropped() const
+    {
+        return m_dropped;
+    }
+
+    /*!
+     * \brief Resets the number of dropped messages.
+     */
+    void resetDropped()
+    {
+        m_dropped = 0;
+    }
+
+private:
+    uint8_t m_data[TSize];
+    uint16_t m_head = 0;
+    uint16_t m_tail = 0;
+    uint16_t m_size = 0;
+    uint16_t m_dropped = 0;
+    uint8_t m_remaining = 0;
+
+    void write(uint8_t value)
+    {
+        m_data[m_head] = value;
+        if (++m_head == TSize)
+            m_head = 0;
+        ++m_size;
+    }
+
+    uint8_t read()
+    {
+        uint8_t value = m_data[m_tail];
+        if (++m_tail == TSize)
+            m_tail = 0;
+        --m_size;
+        return value;
+    }
+
+    void skip(uint8_t length)
+    {
+        m_tail = (m_tail + length) % TSize;
+        m_size -= length;
+    }
+
+    static void increment(uint16_t &counter)
+    {
+        if (counter != UINT16_MAX)
+            ++counter;
+    }
+};
+
+/*! \} */  // \addtogroup libsensors_messagequeue
+
+}  // namespace Sensors
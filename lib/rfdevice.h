@@ -34,6 +34,8 @@
  * \copydoc libsensors_rfdevice
  */
 
+#include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
+
 #include "demodulator.h"
 #include "bitdecoder.h"
 #include "sensor.h"
@@ -69,6 +71,177 @@ enum class RfDeviceStatus : uint8_t {
     InvalidData
 };
 
+/*!
+ * \brief Decoder counters of an RfDevice.
+ *
+ * All counters saturate instead of wrapping around. The pulse counters grow
+ * at the edge rate of the receiver (thousands per second in noise) and are
+ * therefore 32 bit wide.
+ */
+struct RfDeviceCounters
+{
+    uint32_t pulses = 0;             //!< Pulse widths added
+    uint16_t frames = 0;             //!< Completely decoded messages
+    uint32_t demodulatorErrors = 0;  //!< Pulse widths out of range
+    uint16_t parityErrors = 0;       //!< Bytes with parity errors
+    uint16_t tooMuchData = 0;        //!< Messages exceeding the sensor length
+    uint16_t invalidData = 0;        //!< Messages rejected by the sensor
+};
+
+/*!
+ * \brief RfDevice statistics configuration that doesn't keep any counters.
+ *
+ * This is the default, it doesn't add any overhead.
+ */
+class NoRfDeviceStatistics
+{
+protected:
+    static void count(uint16_t RfDeviceCounters::*)
+    {
+    }
+
+    static void count(uint32_t RfDeviceCounters::*)
+    {
+    }
+};
+
+/*!
+ * \brief RfDevice statistics configuration that keeps RfDeviceCounters.
+ *
+ * Usage:
+ * \code
+ * HidekiDevice<..., RfDeviceStatistics> device;
+ * // ...
+ * uint16_t frames = device.statistics().frames;
+ * \endcode
+ */
+class RfDeviceStatistics
+{
+public:
+    /*!
+     * \brief Returns the decoder counters.
+     *
+     * \return The RfDeviceCounters.
+     */
+    const RfDeviceCounters &statistics() const
+    {
+        return m_counters;
+    }
+
+    /*!
+     * \brief Resets all decoder counters.
+     */
+    void resetStatistics()
+    {
+        m_counters = RfDeviceCounters();
+    }
+
+protected:
+    void count(uint16_t RfDeviceCounters::*counter)
+    {
+        uint16_t &value = m_counters.*counter;
+        if (value != UINT16_MAX)
+            ++value;
+    }
+
+    void count(uint32_t RfDeviceCounters::*counter)
+    {
+        uint32_t &value = m_counters.*counter;
+        if (value != UINT32_MAX)
+            ++value;
+    }
+
+private:
+    RfDeviceCounters m_counters;
+};
+
+/*!
+ * \brief RfDevice state configuration with separate members for the bit
+ *        counter and the status.
+ *
+ * This is the default, it results in the fastest code.
+ */
+class RfDeviceState
+{
+public:
+    /*!
+     * \brief Maximum message length (in bits).
+     */
+    static const uint16_t c_maxBitLength = UINT16_MAX;
+
+protected:
+    uint16_t bitLength() const
+    {
+        return m_bitLength;
+    }
+
+    void setBitLength(uint16_t bitLength)
+    {
+        m_bitLength = bitLength;
+    }
+
+    RfDeviceStatus lastStatus() const
+    {
+        return m_lastStatus;
+    }
+
+    void setLastStatus(RfDeviceStatus status)
+    {
+        m_lastStatus = status;
+    }
+
+private:
+    uint16_t m_bitLength = 0;
+    RfDeviceStatus m_lastStatus = RfDeviceStatus::Incomplete;
+};
+
+/*!
+ * \brief RfDevice state configuration packing the bit counter and the status
+ *        into bitfields.
+ *
+ * Saves one byte per RfDevice at the cost of a few additional instructions
+ * per pulse width for masking and shifting.
+ */
+class PackedRfDeviceState
+{
+public:
+    /*!
+     * \brief Maximum message length (in bits).
+     */
+    static const uint16_t c_maxBitLength = (1 << 14) - 1;
+
+protected:
+    PackedRfDeviceState()
+        : m_bitLength(0),
+          m_lastStatus(static_cast<uint8_t>(RfDeviceStatus::Incomplete))
+    {
+    }
+
+    uint16_t bitLength() const
+    {
+        return m_bitLength;
+    }
+
+    void setBitLength(uint16_t bitLength)
+    {
+        m_bitLength = bitLength;
+    }
+
+    RfDeviceStatus lastStatus() const
+    {
+        return static_cast<RfDeviceStatus>(m_lastStatus);
+    }
+
+    void setLastStatus(RfDeviceStatus status)
+    {
+        m_lastStatus = static_cast<uint8_t>(status);
+    }
+
+private:
+    uint16_t m_bitLength : 14;
+    uint16_t m_lastStatus : 2;
+};
+
 /*!
  * \brief Connects \ref libsensors_demodulator, \ref libsensors_bitdecoder and
  *        \ref libsensors_sensor for decoding sensor data from RF receivers.
@@ -100,6 +273,10 @@ enum class RfDeviceStatus : uint8_t {
  * \tparam TBitLength Maximum length of a message in bits. If set to a non-zero
  *         value, the RfDevice will expect to receive as many bits as specified
  *         before the \p TSensor is called for decoding the data.
+ * \tparam TStatistics The statistics configuration (NoRfDeviceStatistics or
+ *         RfDeviceStatistics).
+ * \tparam TState The state configuration (RfDeviceState or
+ *         PackedRfDeviceState).
  *
  *  \attention This class must not be used directly, it only serves as template
  *             for specific RF devices.
@@ -107,12 +284,19 @@ enum class RfDeviceStatus : uint8_t {
 template <typename TDemodulator,
           typename TBitDecoder,
           typename TSensor,
-          uint16_t TBitLength = 0>
+          uint16_t TBitLength = 0,
+          typename TStatistics = NoRfDeviceStatistics,
+          typename TState = RfDeviceState>
 class RfDevice :
         private TDemodulator,
         private TBitDecoder,
-        public TSensor
+        public TSensor,
+        public TStatistics,
+        private TState
 {
+    static_assert(TBitLength <= TState::c_maxBitLength,
+                  "TBitLength exceeds the maximum of TState");
+
 public:
     /*!
      * \brief Adds the \p pulseWidth value to the RfDevice state.
@@ -125,11 +309,12 @@ public:
      */
     RfDeviceStatus addPulseWidth(uint16_t pulseWidth)
     {
-        if (m_lastStatus == RfDeviceStatus::InvalidData)
+        if (TState::lastStatus() == RfDeviceStatus::InvalidData)
             reset();
 
-        m_lastStatus = internalAddPulseWidth(pulseWidth);
-        return m_lastStatus;
+        RfDeviceStatus status = internalAddPulseWidth(pulseWidth);
+        TState::setLastStatus(status);
+        return status;
     }
 
     /*!
@@ -140,26 +325,30 @@ public:
         TDemodulator::reset();
         TBitDecoder::reset();
         TSensor::reset();
-        m_bitLength = 0;
+        TState::setBitLength(0);
     }
 
 private:
     RfDeviceStatus internalAddPulseWidth(uint16_t pulseWidth)
     {
+        TStatistics::count(&RfDeviceCounters::pulses);
         auto demodulatorStatus = TDemodulator::addPulseWidth(pulseWidth);
         if (demodulatorStatus == DemodulatorStatus::Incomplete) {
             return RfDeviceStatus::Incomplete;
         } else if (demodulatorStatus != DemodulatorStatus::Complete) {
+            TStatistics::count(&RfDeviceCounters::demodulatorErrors);
             return RfDeviceStatus::InvalidData;
         }
 
         // Bit
         auto decoderStatus = TBitDecoder::addBit(TDemodulator::getData());
         if (decoderStatus == BitDecoderStatus::ParityError) {
+            TStatistics::count(&RfDeviceCounters::parityErrors);
             return RfDeviceStatus::InvalidData;
         }
-        ++m_bitLength;
-        if (m_bitLength != TBitLength &&
+        uint16_t bitLength = TState::bitLength() + 1;
+        TState::setBitLength(bitLength);
+        if (bitLength != TBitLength &&
             decoderStatus != BitDecoderStatus::Complete) {
             return RfDeviceStatus::Incomplete;
         }
@@ -168,15 +357,17 @@ private:
         auto sensorStatus = TSensor::addByte(TBitDecoder::getData());
         if (sensorStatus == SensorStatus::Incomplete) {
             return RfDeviceStatus::Incomplete;
+        } else if (sensorStatus == SensorStatus::TooMuchData) {
+            TStatistics::count(&RfDeviceCounters::tooMuchData);
+            return RfDeviceStatus::InvalidData;
         } else if (sensorStatus != SensorStatus::Complete) {
+            TStatistics::count(&RfDeviceCounters::invalidData);
             return RfDeviceStatus::InvalidData;
         }
 
+        TStatistics::count(&RfDeviceCounters::frames);
         return RfDeviceStatus::Complete;
     }
-
-    uint16_t m_bitLength = 0;
-    RfDeviceStatus m_lastStatus = RfDeviceStatus::Incomplete;
 };
 
 /*! \} */  // \addtogroup libsensors_rfdevice
@@ -0,0 +1,265 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#pragma once
+
+/*!
+ * \defgroup libsensors_ringbuffer Ring buffer
+ * \ingroup libsensors
+ *
+ * \brief Sensors::RingBuffer is a fixed size single-producer/single-consumer
+ *        queue for passing data from an interrupt service routine to the
+ *        main loop without disabling interrupts.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_ringbuffer
+ * \copydoc libsensors_ringbuffer
+ */
+
+#include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
+
+#ifndef __AVR__
+#include <atomic>
+#endif
+
+namespace Sensors
+{
+
+namespace internal
+{
+
+#ifdef __AVR__
+/*!
+ * \brief Counter shared between the producer and the consumer of
+ *        Sensors::RingBuffer.
+ *
+ * Single bytes are read and written atomically on AVR. The compiler
+ * barriers keep data accesses on the correct side of index updates.
+ */
+template <typename T>
+class RingBufferCounter
+{
+public:
+    T load() const
+    {
+        T value = m_value;
+        barrier();
+        return value;
+    }
+
+    void store(T value)
+    {
+        barrier();
+        m_value = value;
+    }
+
+    // Multi-byte counters are read until two consecutive reads match since
+    // they may be modified by an ISR in between.
+    T loadConsistent() const
+    {
+        T value;
+        do {
+            value = m_value;
+        } while (value != m_value);
+        return value;
+    }
+
+private:
+    static void barrier()
+    {
+        __asm__ __volatile__("" ::: "memory");
+    }
+
+    volatile T m_value = 0;
+};
+#else
+/*!
+ * \brief Counter shared between the producer and the consumer of
+ *        Sensors::RingBuffer.
+ *
+ * Uses std::atomic with acquire / release semantics so that the ring buffer
+ * can also be shared between threads on the host.
+ */
+template <typename T>
+class RingBufferCounter
+{
+public:
+    T load() const
+    {
+        return m_value.load(std::memory_order_acquire);
+    }
+
+    void store(T value)
+    {
+        m_value.store(value, std::memory_order_release);
+    }
+
+    T loadConsistent() const
+    {
+        return load();
+    }
+
+private:
+    std::atomic<T> m_value{0};
+};
+#endif
+
+}  // namespace internal
+
+/*!
+ * \addtogroup libsensors_ringbuffer
+ * \{
+ */
+
+/*!
+ * \brief Lock-free single-producer/single-consumer ring buffer.
+ *
+ * The producer (typically an interrupt service routine) only modifies the
+ * head index, the consumer (typically the main loop) only modifies the tail
+ * index. Both indices are single bytes that can be read and written
+ * atomically on AVR, so no interrupts have to be disabled for exchanging
+ * data. On the host, the indices are `std::atomic` so that producer and
+ * consumer can run in different threads.
+ *
+ * Usage:
+ * \code
+ * Sensors::RingBuffer<uint16_t, 64> buffer;
+ *
+ * ISR(...) {
+ *     buffer.push(value);
+ * }
+ *
+ * int main() {
+ *     uint16_t value;
+ *     while (buffer.pop(value)) {
+ *         // ...
+ *     }
+ * }
+ * \endcode
+ *
+ * \tparam T Data type of the elements.
+ * \tparam TSize Capacity of the buffer. Has to be a power of two and must
+ *         not exceed 128 elements.
+ */
+template <typename T, uint8_t TSize>
+class RingBuffer
+{
+    static_assert(TSize > 0 && (TSize & (TSize - 1)) == 0,
+                  "TSize must be a power of two");
+    static_assert(TSize <= 128, "TSize must not exceed 128 elements");
+
+public:
+    /*!
+     * \brief Appends \p value to the buffer (producer side).
+     *
+     * \param value The value to append.
+     * \return `true` if the value has been appended, `false` if the buffer
+     *         is full. In that case the overflow counter is incremented.
+     */
+    bool push(const T &value)
+    {
+        uint8_t head = m_head.load();
+        if (static_cast<uint8_t>(head - m_tail.load()) == TSize) {
+            uint16_t overflows = m_overflows.load();
+            if (overflows != UINT16_MAX)
+                m_overflows.store(overflows + 1);
+            return false;
+        }
+
+        m_data[head & c_mask] = value;
+        m_head.store(head + 1);
+        return true;
+    }
+
+    /*!
+     * \brief Removes the oldest value from the buffer (consumer side).
+     *
+     * \param value Memory location the removed value is stored into.
+     * \return `true` if a value has been removed, `false` if the buffer is
+     *         empty.
+     */
+    bool pop(T &value)
+    {
+        uint8_t tail = m_tail.load();
+        if (tail == m_head.load())
+            return false;
+
+        value = m_data[tail & c_mask];
+        m_tail.store(tail + 1);
+        return true;
+    }
+
+    /*!
+     * \brief Determines if the buffer is empty.
+     *
+     * \return `true` if the buffer is empty, `false` otherwise.
+     */
+    bool isEmpty() const
+    {
+        return m_head.load() == m_tail.load();
+    }
+
+    /*!
+     * \brief Returns the number of values stored in the buffer.
+     *
+     * \return The number of values stored in the buffer.
+     */
+    uint8_t size() const
+    {
+        return static_cast<uint8_t>(m_head.load() - m_tail.load());
+    }
+
+    /*!
+     * \brief Returns the capacity of the buffer.
+     *
+     * \return The capacity of the buffer.
+     */
+    static constexpr uint8_t capacity()
+    {
+        return TSize;
+    }
+
+    /*!
+     * \brief Returns the number of values that have been dropped because
+     *        the buffer was full.
+     *
+     * The counter saturates at `UINT16_MAX`. It can be read from the
+     * consumer side without disabling interrupts.
+     *
+     * \return The number of dropped values.
+     */
+    uint16_t overflows() const
+    {
+        return m_overflows.loadConsistent();
+    }
+
+private:
+    static const uint8_t c_mask = TSize - 1;
+
+    T m_data[TSize];
+    internal::RingBufferCounter<uint8_t> m_head;
+    internal::RingBufferCounter<uint8_t> m_tail;
+    internal::RingBufferCounter<uint16_t> m_overflows;
+};
+
+/*! \} */  // \addtogroup libsensors_ringbuffer
+
+}  // namespace Sensors
@@ -35,6 +35,8 @@
 
 #include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
 
+#include "fixedpoint.h"
+
 namespace Sensors
 {
 
@@ -56,14 +58,20 @@ class Tgs2600
     static_assert(TLoadResistance >= 450, "Minimum load resistance 450 Ohm.");
 
 public:
+    /*!
+     * \brief Fixed point type used for the calibration factor and the
+     *        relative sensor resistance.
+     */
+    using Factor = FixedPoint<4>;
+
     /*!
      * \brief Initializes the TGS 2600 sensor decoder.
      */
     Tgs2600()
-        : m_referenceResistance(1.0F)
+        : m_referenceResistance(1)
         , m_referenceHumidity(65)
         , m_referenceTemperature(20)
-        , m_calibration(1.0F)
+        , m_calibration(1)
     {
     }
 
@@ -104,7 +112,7 @@ public:
         if (sensorResistance == UINT32_MAX)
             return UINT32_MAX;
 
-        return m_calibration * sensorResistance;
+        return m_calibration.multiply(sensorResistance);
     }
 
     /*!
@@ -115,12 +123,13 @@ public:
      * can be specified with setReferenceResistance().
      *
      * \param vout Voltage meassured using an Analog to Digital Convertor (ADC).
-     * \return The sensor resistance.
+     * \return The relative sensor resistance.
      * \sa sensorResistanceCalibrated
      */
-    float sensorResistanceRelative(uint32_t vout) const
+    Factor sensorResistanceRelative(uint32_t vout) const
     {
-        return sensorResistanceCalibrated(vout) / m_referenceResistance;
+        return Factor::fromRatio(sensorResistanceCalibrated(vout),
+                                 m_referenceResistance);
     }
 
     /*!
@@ -128,7 +137,7 @@ public:
      *        sensorResistanceRelative()
      * \param humidity Reference humidity.
      */
-    void setReferenceHumidity(float humidity)
+    void setReferenceHumidity(SensorValue humidity)
     {
         m_referenceHumidity = humidity;
         updateCalibration();
@@ -139,7 +148,7 @@ public:
      *        and sensorResistanceRelative().
      * \param temperature Reference temperature.
      */
-    void setReferenceTemperature(float temperature)
+    void setReferenceTemperature(SensorValue temperature)
     {
         m_referenceTemperature = temperature;
         updateCalibration();
@@ -147,9 +156,9 @@ public:
 
     /*!
      * \brief Sets reference \p resistance for sensorResistanceRelative().
-     * \param resistance Reference resistance.
+     * \param resistance Reference resistance in Ohm.
      */
-    void setReferenceResistance(float resistance)
+    void setReferenceResistance(uint32_t resistance)
     {
         m_referenceResistance = resistance;
     }
@@ -161,7 +170,7 @@ public:
      * \sa sensorResistanceCalibrated
      * \sa setReferenceHumidity, setReferenceTemperature
      */
-    float calibration() const
+    Factor calibration() const
     {
         return m_calibration;
     }
@@ -169,18 +178,19 @@ public:
 private:
     void updateCalibration()
     {
-        m_calibration = 0.024F +
-                        0.0072F * m_referenceHumidity +
-                        0.0246F * m_referenceTemperature;
+        // 0.024 + 0.0072 * humidity + 0.0246 * temperature
+        m_calibration = Factor::fromRaw(240) +
+                        Factor::fromRaw(72) * m_referenceHumidity +
+                        Factor::fromRaw(246) * m_referenceTemperature;
     }
 
     // Sensor requires Vc of 5V.
     static const uint16_t c_vcc = 5000;
 
-    float m_referenceResistance;
-    float m_referenceHumidity;
-    float m_referenceTemperature;
-    float m_calibration;
+    uint32_t m_referenceResistance;
+    SensorValue m_referenceHumidity;
+    SensorValue m_referenceTemperature;
+    Factor m_calibration;
 };
 
 /*! \} */  // \addtogroup libsensors_tgs2600
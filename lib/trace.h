@@ -0,0 +1,265 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#pragma once
+
+/*!
+ * \defgroup libsensors_trace Trace buffer
+ * \ingroup libsensors
+ *
+ * \brief Sensors::TraceBuffer records timestamped events for analyzing where
+ *        time is spent on the target.
+ *
+ * The target records (event, timestamp) pairs into a Sensors::TraceBuffer
+ * and dumps them as text lines:
+ *
+ *     TRACE <count>
+ *     <event (2 hex digits)> <timestamp (4 hex digits)>
+ *     ...
+ *     TRACE END
+ *
+ * On the host, the lines are parsed with Sensors::parseTraceRecord() and
+ * begin / end events are paired to sections with
+ * Sensors::TraceSectionMatcher (see \ref tools_tracetool).
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_trace
+ * \copydoc libsensors_trace
+ */
+
+#include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
+
+namespace Sensors
+{
+
+/*!
+ * \addtogroup libsensors_trace
+ * \{
+ */
+
+/*!
+ * \brief Traced events.
+ *
+ * The event id is stored in the lower 7 bits, see c_traceEnd.
+ */
+enum class TraceEvent : uint8_t {
+    InputCapture = 0x01,   //!< RF input capture interrupt
+    TimerOverflow = 0x02,  //!< RF timer overflow interrupt
+    Twi = 0x03,            //!< I2C (TWI) interrupt
+    PinChange = 0x04,      //!< DHT22 pin change interrupt
+    Format = 0x10,         //!< Formatting a message
+    Uart = 0x11,           //!< Transmitting a message over the UART
+    Udp = 0x12,            //!< Adding a message to / sending a datagram
+    Task = 0x40            //!< Scheduler task (task index is added)
+};
+
+/*!
+ * \brief Flag marking the end of a traced section.
+ */
+static const uint8_t c_traceEnd = 0x80;
+
+/*!
+ * \brief A single traced event.
+ */
+struct TraceRecord
+{
+    uint8_t event;       //!< Event id, c_traceEnd is set for section ends
+    uint16_t timestamp;  //!< Timer value (wraps around)
+};
+
+/*!
+ * \brief Ring buffer keeping the most recent trace records.
+ *
+ * Older records are overwritten. The buffer is not synchronized, interrupts
+ * have to be disabled while adding records from different contexts.
+ *
+ * \tparam TSize Capacity of the buffer. Has to be a power of two and must
+ *         not exceed 128 records.
+ */
+template <uint8_t TSize>
+class TraceBuffer
+{
+    static_assert(TSize > 0 && (TSize & (TSize - 1)) == 0,
+                  "TSize must be a power of two");
+    static_assert(TSize <= 128, "TSize must not exceed 128 records");
+
+public:
+    /*!
+     * \brief Adds a record, overwriting the oldest one if the buffer is
+     *        full.
+     *
+     * \param event The event id.
+     * \param timestamp The current timer value.
+     */
+    void add(uint8_t event, uint16_t timestamp)
+    {
+        TraceRecord &record = m_records[m_next & c_mask];
+        record.event = event;
+        record.timestamp = timestamp;
+        ++m_next;
+        if (m_size < TSize)
+            ++m_size;
+    }
+
+    /*!
+     * \brief Removes all records.
+     */
+    void clear()
+    {
+        m_size = 0;
+    }
+
+    /*!
+     * \brief Returns the number of records.
+     *
+     * \return The number of records.
+     */
+    uint8_t size() const
+    {
+        return m_size;
+    }
+
+    /*!
+     * \brief Returns the record at \p index, oldest first.
+     *
+     * \param index The index (`0` to size() - 1).
+     * \return The record.
+     */
+    const TraceRecord &operator[](uint8_t index) const
+    {
+        return m_records[static_cast<uint8_t>(m_next - m_size + index) &
+                         c_mask];
+    }
+
+private:
+    static const uint8_t c_mask = TSize - 1;
+
+    TraceRecord m_records[TSize];
+    uint8_t m_next = 0;
+    uint8_t m_size = 0;
+};
+
+/*!
+ * \brief A completed section (matching begin and end events).
+ */
+struct TraceSection
+{
+    uint8_t event;       //!< Event id (without c_traceEnd)
+    uint16_t begin;      //!< Timestamp of the begin event
+    uint16_t duration;   //!< Duration in timer ticks
+    uint8_t depth;       //!< Nesting depth (`0` for outermost sections)
+};
+
+/*!
+ * \brief Pairs begin and end events of a record sequence to sections.
+ *
+ * Sections may be nested (e.g. an interrupt during a task). End events
+ * without matching begin event are ignored. If an end event closes a
+ * section that is not the innermost one, the inner sections are discarded.
+ *
+ * \note Durations are only correct for sections shorter than one period of
+ *       the 16 bit timer.
+ */
+class TraceSectionMatcher
+{
+public:
+    /*!
+     * \brief Adds the next \p record.
+     *
+     * \param record The record.
+     * \param section Memory location the completed section is stored into.
+     * \return `true` if \p record completed a section, `false` otherwise.
+     */
+    bool add(const TraceRecord &record, TraceSection &section)
+    {
+        uint8_t event = record.event & ~c_traceEnd;
+        if (!(record.event & c_traceEnd)) {
+            if (m_depth == c_maxDepth)
+                return false;
+            m_open[m_depth++] = record;
+            return false;
+        }
+
+        for (uint8_t depth = m_depth; depth > 0; --depth) {
+            const TraceRecord &begin = m_open[depth - 1];
+            if (begin.event == event) {
+                section.event = event;
+                section.begin = begin.timestamp;
+                section.duration = record.timestamp - begin.timestamp;
+                section.depth = depth - 1;
+                m_depth = depth - 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    static const uint8_t c_maxDepth = 8;
+
+    TraceRecord m_open[c_maxDepth];
+    uint8_t m_depth = 0;
+};
+
+/*!
+ * \brief Parses a record line (`<event> <timestamp>` in hex) of a trace
+ *        dump.
+ *
+ * \param line The null-terminated line.
+ * \param record Memory location the parsed record is stored into.
+ * \return `true` if \p line is a record, `false` otherwise.
+ */
+inline bool parseTraceRecord(const char *line, TraceRecord &record)
+{
+    uint16_t values[2] = {0, 0};
+    uint8_t digits[2] = {0, 0};
+    uint8_t field = 0;
+    for (; *line && *line != '\n' && *line != '\r'; ++line) {
+        char c = *line;
+        uint8_t digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        } else if (c == ' ' && field == 0 && digits[0] > 0) {
+            field = 1;
+            continue;
+        } else {
+            return false;
+        }
+        if (digits[field] == (field == 0 ? 2 : 4))
+            return false;
+        values[field] = values[field] << 4 | digit;
+        ++digits[field];
+    }
+
+    if (digits[0] != 2 || digits[1] != 4)
+        return false;
+    record.event = values[0];
+    record.timestamp = values[1];
+    return true;
+}
+
+/*! \} */  // \addtogroup libsensors_trace
+
+}  // namespace Sensors
@@ -177,6 +177,31 @@ inline bool parity(int x)
     return __builtin_parity(x);
 }
 
+/*!
+ * \brief Updates the LSB first (reflected) CRC-8 \p crc with the \p byte.
+ *
+ * The CRC is calculated bitwise to avoid a lookup table. Feeding the CRC of
+ * a message into the CRC of the message itself results in `0` (if the
+ * final XOR value is `0`).
+ *
+ * \param crc The current CRC value (initial value for the first byte).
+ * \param byte The byte to add to the CRC.
+ * \param polynomial The reflected polynomial (e.g. `0xE0` for `0x07`).
+ * \return The updated CRC value.
+ */
+inline uint8_t crc8Lsb(uint8_t crc, uint8_t byte, uint8_t polynomial)
+{
+    crc ^= byte;
+    for (uint8_t bit = 0; bit < 8; ++bit) {
+        if ((crc & 0x01) != 0) {
+            crc = (crc >> 1) ^ polynomial;
+        } else {
+            crc >>= 1;
+        }
+    }
+    return crc;
+}
+
 /*!
  * \brief Returns the minimum of the two values \p a and \p b.
  * \tparam T Data type of the values to operate on.
@@ -0,0 +1,440 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#pragma once
+
+/*!
+ * \defgroup libsensors_wireformat Binary wire format
+ * \ingroup libsensors
+ *
+ * \brief Compact binary encoding of sensor values as alternative to JSON.
+ *
+ * A frame contains one or more sensor values. Before framing, the payload is
+ * structured as follows (multi-byte values are little endian):
+ *
+ * | Size | Content                                                   |
+ * |------|-----------------------------------------------------------|
+ * | 1    | Flags (Sensors::WireFlags)                                |
+ * | 0/1  | Sequence number (if Sensors::WireFlags::Sequence is set)  |
+ * | 0/4  | Timestamp (if Sensors::WireFlags::Timestamp is set)       |
+ * | 6*n  | Records: sensor id (1), quantity and digits (1), value (4) |
+ * | 1    | CRC-8 (polynomial `0x31`, LSB first) over all bytes above |
+ *
+ * The sensor id combines the Sensors::WireSensor with a channel in the lower
+ * nibble. The quantity byte contains the Sensors::WireQuantity in the upper
+ * 5 bits and the number of fractional decimal digits of the value in the
+ * lower 3 bits. The value is the raw Sensors::FixedPoint representation.
+ *
+ * The payload is COBS encoded (\ref libsensors_cobs) and terminated by a
+ * `0x00` delimiter. A DHT22 reading (temperature and humidity) takes 17
+ * bytes compared to about 50 bytes as JSON line.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_wireformat
+ * \copydoc libsensors_wireformat
+ */
+
+#include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
+
+#include "cobs.h"
+#include "fixedpoint.h"
+#include "sensor.h"
+#include "utils.h"
+
+namespace Sensors
+{
+
+/*!
+ * \addtogroup libsensors_wireformat
+ * \{
+ */
+
+/*!
+ * \brief Flags in the first byte of a frame.
+ */
+namespace WireFlags
+{
+/*! The frame contains a sequence number. */
+static const uint8_t Sequence = 0x01;
+/*! The frame contains a timestamp. */
+static const uint8_t Timestamp = 0x02;
+}  // namespace WireFlags
+
+/*!
+ * \brief Sensor types (upper nibble of the sensor id).
+ */
+enum class WireSensor : uint8_t {
+    Rf433 = 0x10,      //!< Wireless sensors (channel in the lower nibble)
+    Dht22 = 0x20,      //!< DHT22 sensor
+    Bmp180 = 0x30,     //!< Bosch BMP180 sensor
+    Mlx90614 = 0x40,   //!< Melexis MLX90614 sensor
+    Tgs2600 = 0x50,    //!< Figaro TGS 2600 sensor
+    Task = 0x60,       //!< Scheduler task (task index in the lower nibble)
+    System = 0x70,     //!< System health (CPU load, memory usage)
+    RfReceiver = 0x80, //!< RF receiver health (noise storms, decoder)
+    Twi = 0x90,        //!< I2C (TWI) bus health
+    Udp = 0xA0,        //!< UDP transmission health
+    Uart = 0xB0        //!< UART transmission health
+};
+
+/*!
+ * \brief Measured quantities.
+ */
+enum class WireQuantity : uint8_t {
+    Temperature = 1,           //!< Temperature in °C
+    Humidity,                  //!< Relative humidity in %
+    Pressure,                  //!< Barometric pressure in hPa
+    AmbientTemperature,        //!< Ambient temperature in °C
+    ObjectTemperature,         //!< Object temperature in °C
+    Resistance,                //!< Resistance in Ohm
+    ResistanceCalibrated,      //!< Calibrated resistance in Ohm
+    Battery,                   //!< Battery status (`1`: ok, `0`: low)
+    Runs,                      //!< Number of task runs
+    RuntimeAverage,            //!< Average task runtime in us
+    RuntimeMax,                //!< Maximum task runtime in us
+    DeadlineMisses,            //!< Number of missed task deadlines
+    SleepTime,                 //!< Time spent sleeping in ms
+    WorkTime,                  //!< Time spent working in ms
+    Storms,                    //!< Number of RF noise storms
+    Backoffs,                  //!< Number of RF capture back-offs
+    Glitches,                  //!< Number of filtered RF glitches
+    Pulses,                    //!< Number of received RF pulses
+    Frames,                    //!< Number of decoded RF frames
+    DemodulatorErrors,         //!< Number of RF pulses out of range
+    ParityErrors,              //!< Number of RF parity errors
+    TooMuchData,               //!< Number of too long RF frames
+    InvalidData,               //!< Number of invalid RF frames
+    Dropped,                   //!< Number of dropped frames or messages
+    Errors,                    //!< Number of errors
+    Timeouts,                  //!< Number of timeouts
+    StaticMemory,              //!< Size of static variables in bytes
+    StackMax,                  //!< Maximum stack usage in bytes
+    StackUnused,               //!< Memory never used by the stack in bytes
+    Overflows                  //!< Number of RF pulses lost to a full buffer
+};
+
+// The quantity is stored in the upper 5 bits of the quantity byte
+static_assert(static_cast<uint8_t>(WireQuantity::Overflows) < 32,
+              "Too many quantities");
+
+/*!
+ * \brief Returns the sensor id for the \p sensor type and \p channel.
+ *
+ * \param sensor The sensor type.
+ * \param channel The channel (`0`-`15`).
+ * \return The sensor id.
+ */
+inline uint8_t wireSensorId(WireSensor sensor, uint8_t channel = 0)
+{
+    return static_cast<uint8_t>(sensor) | lowNibble(channel);
+}
+
+/*!
+ * \brief A single sensor value within a frame.
+ */
+struct WireRecord
+{
+    uint8_t sensorId;       //!< Sensor id (see wireSensorId())
+    WireQuantity quantity;  //!< The measured quantity
+    uint8_t digits;         //!< Number of fractional decimal digits
+    int32_t raw;            //!< The value multiplied by `10^digits`
+};
+
+/*! \cond */
+namespace internal
+{
+static const uint8_t c_wireRecordSize = 6;
+static const uint8_t c_wireCrcPolynomial = 0x8C;  // 0x31 (LSB first)
+
+inline void writeUInt32(uint8_t *data, uint32_t value)
+{
+    for (uint8_t i = 0; i < 4; ++i) {
+        data[i] = value >> (8 * i);
+    }
+}
+
+inline uint32_t readUInt32(const uint8_t *data)
+{
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(data[i]) << (8 * i);
+    }
+    return value;
+}
+
+inline uint8_t wireCrc(const uint8_t *data, uint16_t length)
+{
+    uint8_t crc = 0;
+    for (uint16_t i = 0; i < length; ++i) {
+        crc = crc8Lsb(crc, data[i], c_wireCrcPolynomial);
+    }
+    return crc;
+}
+}  // namespace internal
+/*! \endcond */
+
+/*!
+ * \brief Builds and encodes a frame in the binary wire format.
+ *
+ * Usage:
+ * \code
+ * Sensors::WireFrame<32> frame;
+ * frame.begin(sequence);
+ * frame.add(Sensors::wireSensorId(Sensors::WireSensor::Dht22),
+ *           Sensors::WireQuantity::Temperature, dht22.temperature());
+ * frame.encode(sink);
+ * \endcode
+ *
+ * \tparam TCapacity Maximum payload size (including header and CRC).
+ */
+template <uint8_t TCapacity>
+class WireFrame
+{
+    static_assert(TCapacity >= 8 && TCapacity < 254,
+                  "TCapacity must be between 8 and 253 bytes");
+
+public:
+    /*!
+     * \brief Starts a frame without sequence number and timestamp.
+     */
+    void begin()
+    {
+        m_length = 0;
+        m_data[m_length++] = 0;
+    }
+
+    /*!
+     * \brief Starts a frame with a \p sequence number.
+     *
+     * \param sequence The sequence number.
+     */
+    void begin(uint8_t sequence)
+    {
+        m_length = 0;
+        m_data[m_length++] = WireFlags::Sequence;
+        m_data[m_length++] = sequence;
+    }
+
+    /*!
+     * \brief Starts a frame with a \p sequence number and a \p timestamp.
+     *
+     * \param sequence The sequence number.
+     * \param timestamp The timestamp.
+     */
+    void begin(uint8_t sequence, uint32_t timestamp)
+    {
+        m_length = 0;
+        m_data[m_length++] = WireFlags::Sequence | WireFlags::Timestamp;
+        m_data[m_length++] = sequence;
+        internal::writeUInt32(&m_data[m_length], timestamp);
+        m_length += 4;
+    }
+
+    /*!
+     * \brief Adds a value to the frame.
+     *
+     * \param sensorId The sensor id (see wireSensorId()).
+     * \param quantity The measured quantity.
+     * \param value The value.
+     * \return `true` if the value has been added, `false` if the frame is
+     *         full.
+     */
+    template <uint8_t TDigits>
+    bool add(uint8_t sensorId, WireQuantity quantity,
+             FixedPoint<TDigits> value)
+    {
+        // Keep space for the CRC
+        if (m_length + internal::c_wireRecordSize + 1 > TCapacity)
+            return false;
+
+        m_data[m_length++] = sensorId;
+        m_data[m_length++] = static_cast<uint8_t>(quantity) << 3 | TDigits;
+        internal::writeUInt32(&m_data[m_length], value.raw());
+        m_length += 4;
+        return true;
+    }
+
+    /*!
+     * \brief Adds the CRC and writes the COBS encoded frame including the
+     *        frame delimiter into the \p sink.
+     *
+     * \tparam TSink Sink the encoded bytes are written into. Has to provide
+     *         a method `write(char)`.
+     * \param sink The sink the encoded bytes are written into.
+     */
+    template <typename TSink>
+    void encode(TSink &sink)
+    {
+        m_data[m_length] = internal::wireCrc(m_data, m_length);
+        cobsEncode(m_data, m_length + 1, sink);
+        sink.write('\0');
+    }
+
+private:
+    uint8_t m_data[TCapacity];
+    uint8_t m_length = 0;
+};
+
+/*!
+ * \brief Decodes frames in the binary wire format from a byte stream.
+ *
+ * Bytes are added with addByte() until a frame is complete. After
+ * transmission errors, the decoder resynchronizes at the next frame
+ * delimiter.
+ *
+ * \tparam TCapacity Maximum encoded frame size (without delimiter).
+ */
+template <uint16_t TCapacity>
+class WireDecoder
+{
+public:
+    /*!
+     * \brief Adds the next received \p byte.
+     *
+     * \param byte The received byte.
+     * \return SensorStatus::Complete if a valid frame has been decoded,
+     *         SensorStatus::Incomplete if more bytes are needed,
+     *         SensorStatus::InvalidData if a corrupted frame has been
+     *         dropped and SensorStatus::TooMuchData if a frame exceeding the
+     *         capacity has been dropped.
+     */
+    SensorStatus addByte(uint8_t byte)
+    {
+        if (byte != 0) {
+            if (m_length < TCapacity) {
+                m_data[m_length] = byte;
+            }
+            if (m_length <= TCapacity) {
+                ++m_length;
+            }
+            return SensorStatus::Incomplete;
+        }
+
+        // Frame delimiter
+        uint16_t length = m_length;
+        m_length = 0;
+        m_recordCount = 0;
+        if (length == 0)
+            return SensorStatus::Incomplete;
+        if (length > TCapacity)
+            return SensorStatus::TooMuchData;
+        return decode(length);
+    }
+
+    /*!
+     * \brief Returns the flags of the last decoded frame.
+     *
+     * \return The flags (see Sensors::WireFlags).
+     */
+    uint8_t flags() const
+    {
+        return m_data[0];
+    }
+
+    /*!
+     * \brief Returns the sequence number of the last decoded frame.
+     *
+     * \return The sequence number or `0` if the frame doesn't contain one.
+     */
+    uint8_t sequence() const
+    {
+        return (flags() & WireFlags::Sequence) ? m_data[1] : 0;
+    }
+
+    /*!
+     * \brief Returns the timestamp of the last decoded frame.
+     *
+     * \return The timestamp or `0` if the frame doesn't contain one.
+     */
+    uint32_t timestamp() const
+    {
+        return (flags() & WireFlags::Timestamp) ?
+                    internal::readUInt32(&m_data[2]) : 0;
+    }
+
+    /*!
+     * \brief Returns the number of values in the last decoded frame.
+     *
+     * \return The number of values.
+     */
+    uint8_t recordCount() const
+    {
+        return m_recordCount;
+    }
+
+    /*!
+     * \brief Returns the value at \p index of the last decoded frame.
+     *
+     * \param index The index (`0` to recordCount() - 1).
+     * \return The value.
+     */
+    WireRecord record(uint8_t index) const
+    {
+        const uint8_t *data =
+                &m_data[m_recordStart + index * internal::c_wireRecordSize];
+        WireRecord record;
+        record.sensorId = data[0];
+        record.quantity = static_cast<WireQuantity>(data[1] >> 3);
+        record.digits = data[1] & 0x07;
+        record.raw = static_cast<int32_t>(internal::readUInt32(&data[2]));
+        return record;
+    }
+
+private:
+    SensorStatus decode(uint16_t length)
+    {
+        int16_t decoded = cobsDecode(m_data, length, m_data);
+        if (decoded < 2)
+            return SensorStatus::InvalidData;
+
+        // CRC over the payload including the CRC byte itself results in 0
+        if (internal::wireCrc(m_data, decoded) != 0)
+            return SensorStatus::InvalidData;
+
+        uint8_t headerLength = 1;
+        if (m_data[0] & WireFlags::Sequence)
+            headerLength += 1;
+        if (m_data[0] & WireFlags::Timestamp)
+            headerLength += 4;
+        if ((m_data[0] & WireFlags::Timestamp) &&
+                !(m_data[0] & WireFlags::Sequence))
+            return SensorStatus::InvalidData;
+
+        if (decoded - 1 < headerLength)
+            return SensorStatus::InvalidData;
+        uint16_t recordsLength = decoded - 1 - headerLength;
+        if (recordsLength % internal::c_wireRecordSize != 0)
+            return SensorStatus::InvalidData;
+
+        m_recordStart = headerLength;
+        m_recordCount = recordsLength / internal::c_wireRecordSize;
+        return SensorStatus::Complete;
+    }
+
+    uint8_t m_data[TCapacity];
+    uint16_t m_length = 0;
+    uint8_t m_recordStart = 0;
+    uint8_t m_recordCount = 0;
+};
+
+/*! \} */  // \addtogroup libsensors_wireformat
+
+}  // namespace Sensors
@@ -37,6 +37,9 @@
 
 #include <avr/io.h>
 
+#include "interrupt.h"
+#include "sleep.h"
+
 #ifndef F_CPU
 #error "F_CPU not defined for adc.h"
 #endif
@@ -57,7 +60,8 @@ namespace Avr
  * \brief A C++ wrapper for accessing the built-in 10 bit Analog to Digital
  *        Conversion (ADC) facilities.
  *
- * \note Avr::Adc is currently limited to ADC mode Single Conversion.
+ * \note Avr::Adc is currently limited to ADC mode Single Conversion. The CPU
+ *       sleeps (see Avr::Sleep) while a conversion is in progress.
  * \note The prescaler is automatically configured to the lowest possible
  *       value targeting a sample rate between 50 and 200 kHz for a good
  *       compromise between performance and accuracy.
@@ -116,6 +120,8 @@ public:
     }
 
 private:
+    CLASS_IRQ(ConversionCompleteInterrupt, ADC_vect);
+
     static Adc s_instance;
 
     Adc()
@@ -126,8 +132,8 @@ private:
         // Set ADC prescaler
         ADCSRA |= prescaler();
 
-        // Enable ADC (single conversion)
-        ADCSRA |= (1 << ADEN);
+        // Enable ADC (single conversion) and wake up on completion
+        ADCSRA |= (1 << ADEN) | (1 << ADIE);
 
         // Dummy readout
         read(0);
@@ -137,7 +143,9 @@ private:
     {
         ADMUX = (ADMUX & ~(0x1F)) | (channel & 0x1F);
         ADCSRA |= (1 << ADSC);
-        while (ADCSRA & (1 << ADSC));
+        while (ADCSRA & (1 << ADSC)) {
+            Sleep::instance().idle();
+        }
         return ADCW;
     }
 
@@ -197,6 +205,11 @@ private:
 
 Adc Adc::s_instance = Adc();
 
+void Adc::ConversionCompleteInterrupt()
+{
+    // Only wakes up the CPU
+}
+
 /*! \} */  // \addtogroup libtarget_adc
 
 }  // namespace Avr
@@ -32,9 +32,12 @@
  * \copydoc libtarget_bmp180
  */
 
+#include "lib/bmp180compensation.h"
+#include "lib/fixedpoint.h"
 #include "lib/utils.h"
 
-#include "i2c.h"
+#include "systemclock.h"
+#include "twi.h"
 
 namespace Avr
 {
@@ -48,7 +51,7 @@ namespace Avr
  * \brief Decodes data from Bosch BMP180 Digital pressure sensors.
  *
  * \sa http://ae-bst.resource.bosch.com/media/products/dokumente/bmp180/BST-BMP180-DS000-12~1.pdf
- * \sa http://wmrx00.sourceforge.net/Arduino/BMP085-Calcs.pdf
+ * \sa Sensors::Bmp180Compensation
  */
 class Bmp180
 {
@@ -107,9 +110,9 @@ public:
      *
      * \return The cached temperature value.
      */
-    float temperature() const
+    Sensors::SensorValue temperature() const
     {
-        return m_temperature;
+        return m_compensation.temperature();
     }
 
     /*!
@@ -119,215 +122,306 @@ public:
      *
      * \return The cached absolute pressure value.
      */
-    float pressure() const
+    Sensors::SensorValue pressure() const
     {
-        return m_pressure;
+        return m_compensation.pressure();
     }
 
     /*!
      * \brief Retrieves the cached pressure value relative to sea level.
      *
-     * The barometric pressure value is updated by read.
+     * The barometric pressure value is updated by read. The reduction factor
+     * for the altitude is calculated at compile time.
      *
-     * \param altitude The reference altitude.
+     * \tparam TAltitude The reference altitude in meters.
      * \return The cached pressure value relative to sea level.
      */
-    float pressureAtSeaLevel(float altitude) const {
-        return (static_cast<float>(m_pressure) /
-                pow(1.0f - (static_cast<float>(altitude) / 44330.0f), 5.255f));
+    template <int16_t TAltitude>
+    Sensors::SensorValue pressureAtSeaLevel() const
+    {
+        return m_compensation.pressureAtSeaLevel(
+                    Sensors::Bmp180Compensation::seaLevelFactor<TAltitude>());
+    }
+
+    /*!
+     * \brief Starts the temperature and pressure conversion.
+     *
+     * The conversions take between 9 ms (Mode::UltraLowPower) and 30 ms
+     * (Mode::UltraHighResolution). The transfers are processed by Avr::Twi
+     * in the background, so the CPU is never blocked. The bus stays idle
+     * until the conversion time given in the datasheet has elapsed
+     * (measured with Avr::SystemClock). Only then the end of the conversion
+     * is confirmed with the sensor's start of conversion bit. The
+     * measurement has to be advanced and checked for completion with poll().
+     *
+     * \return `true` if the conversion has been started, `false` if a
+     *         conversion is still pending or couldn't be started.
+     */
+    bool startConversion()
+    {
+        if (m_status == TwiStatus::Pending)
+            return false;
+
+        m_valid = false;
+        m_status = TwiStatus::Pending;
+        if (m_initialized) {
+            startTemperature();
+        } else {
+            // Check presence and load calibration only once
+            m_state = State::ChipId;
+            readRegisters(c_chipIdRegister, m_buffer, 1);
+        }
+        return m_status == TwiStatus::Pending;
+    }
+
+    /*!
+     * \brief Advances the measurement started with startConversion() and
+     *        updates the cached values on completion.
+     *
+     * Has to be called regularly while the measurement is pending. Every
+     * call issues at most one transaction. No transactions are issued while
+     * a conversion is running.
+     *
+     * \return TwiStatus::Pending while the measurement is running,
+     *         TwiStatus::Complete if the values have been updated and
+     *         TwiStatus::Error if an error occurred when accessing the
+     *         sensor.
+     */
+    TwiStatus poll()
+    {
+        while (m_status == TwiStatus::Pending &&
+               !m_transaction.isPending()) {
+            if (m_transaction.status() != TwiStatus::Complete) {
+                // Sensor might have been replaced, check again next time
+                m_initialized = false;
+                m_status = TwiStatus::Error;
+                break;
+            }
+            if (!step())
+                break;
+        }
+        return m_status;
     }
 
     /*!
      * \brief Reads the temperature and pressure from the sensor and updates
      *        the cached values.
+     *
+     * Blocks until the measurement is completed (see startConversion() and
+     * poll()). Interrupts have to be enabled for Avr::Twi and
+     * Avr::SystemClock.
+     *
      * \return `true` if the sensor data could be read, `false` if an error
      *         occurred when accessing the sensor.
      */
     bool read()
     {
-        m_valid = false;
-        if (readUInt8(c_chipIdRegister) != c_chipId)
+        if (!startConversion())
             return false;
 
-        if (!m_initialized) {
-            readCalibration();
-            calculatePolynomials();
-            m_initialized = true;
-        }
-
-        // Calculate temperature
-        float a = m_fc5 * (readTemperature() - m_fc6);
-        m_temperature = a + (m_fmc / (a + m_fmd));
-
-        // Calculate pressure
-        uint32_t pr = readPressure();
-        uint8_t pr0 = pr & 0xFF;
-        uint8_t pr1 = (pr >> 8) & 0xFF;
-        uint8_t pr2 = (pr >> 16) & 0xFF;
-        float pu = (pr2 * 256.00) + pr1 + (pr0 / 256.00);
-        float s = m_temperature - 25.0;
-        float x = (m_fx2 * pow(s, 2)) + (m_fx1 * s) + m_fx0;
-        float y = (m_fy2 * pow(s, 2)) + (m_fy1 * s) + m_fy0;
-        float z = (pu - x) / y;
-        m_pressure = ((m_fp2 * pow(z, 2)) + (m_fp1 * z) + m_fp0);
-
-        m_valid = true;
-        return true;
+        while (poll() == TwiStatus::Pending) {}
+        return m_valid;
     }
 
 private:
-    static const uint8_t c_address           = 0x77;
-    static const uint8_t c_chipId            = 0x55;
-    static const uint8_t c_chipIdRegister    = 0xD0;
-    static const uint8_t c_versionRegister   = 0xD1;
-    static const uint8_t c_softResetRegister = 0xE0;
-    static const uint8_t c_ac1Register       = 0xAA;
-    static const uint8_t c_ac2Register       = 0xAC;
-    static const uint8_t c_ac3Register       = 0xAE;
-    static const uint8_t c_ac4Register       = 0xB0;
-    static const uint8_t c_ac5Register       = 0xB2;
-    static const uint8_t c_ac6Register       = 0xB4;
-    static const uint8_t c_b1Register        = 0xB6;
-    static const uint8_t c_b2Register        = 0xB8;
-    static const uint8_t c_mbRegister        = 0xBA;
-    static const uint8_t c_mcRegister        = 0xBC;
-    static const uint8_t c_mdRegister        = 0xBE;
-    static const uint8_t c_controlRegister   = 0xF4;
-    static const uint8_t c_dataRegister      = 0xF6;
-
-    static const uint8_t c_measureTempCmd    = 0x2E;  //  4.5 ms
-    static const uint8_t c_measurePressure0  = 0x34;  //  4.5 ms
-    static const uint8_t c_measurePressure1  = 0x74;  //  7.5 ms
-    static const uint8_t c_measurePressure2  = 0xB4;  // 13.5 ms
-    static const uint8_t c_measurePressure3  = 0xF4;  // 25.5 ms
+    // Steps of a measurement, each one waits for a single transaction
+    enum class State : uint8_t
+    {
+        ChipId,
+        Calibration,
+        StartTemperature,
+        WaitTemperature,
+        CheckTemperature,
+        ReadTemperature,
+        StartPressure,
+        WaitPressure,
+        CheckPressure,
+        ReadPressure
+    };
+
+    static const uint8_t c_address             = 0x77;
+    static const uint8_t c_chipId              = 0x55;
+    static const uint8_t c_chipIdRegister      = 0xD0;
+    static const uint8_t c_versionRegister     = 0xD1;
+    static const uint8_t c_softResetRegister   = 0xE0;
+    static const uint8_t c_calibrationRegister = 0xAA;
+    static const uint8_t c_controlRegister     = 0xF4;
+    static const uint8_t c_dataRegister        = 0xF6;
+
+    static const uint8_t c_measureTempCmd      = 0x2E;
+    static const uint8_t c_measurePressureCmd  = 0x34;
+    static const uint8_t c_conversionBit       = 5;     // Sco
+
+    static const uint8_t c_temperatureTime     = 5;     // 4.5 ms
 
     Mode m_mode;
     bool m_valid = false;
     bool m_initialized = false;
-    float m_temperature = 0.0;
-    float m_pressure = 0.0;
+    Sensors::Bmp180Compensation m_compensation;
+
+    // Asynchronous access
+    TwiStatus m_status = TwiStatus::Idle;
+    State m_state = State::ChipId;
+    TwiTransaction m_transaction;
+    uint8_t m_register = 0;
+    // Avr::Twi transfers in the background, so the buffer has to outlive
+    // the calls to poll(). It is sized for the calibration burst.
+    uint8_t m_buffer[Sensors::Bmp180Compensation::c_calibrationSize];
+    uint16_t m_rawTemperature = 0;
+    uint32_t m_conversionStart = 0;
+
+    // Processes the result of the last transaction and submits the next one.
+    // Returns false while waiting for a conversion without a transaction.
+    bool step()
+    {
+        switch (m_state) {
+        case State::ChipId:
+            if (m_buffer[0] != c_chipId) {
+                m_status = TwiStatus::Error;
+            } else {
+                // All coefficients are read with a single burst
+                m_state = State::Calibration;
+                readRegisters(c_calibrationRegister, m_buffer,
+                              sizeof(m_buffer));
+            }
+            break;
 
-    // Calibration
-    int16_t m_ac1 = 0, m_ac2 = 0, m_ac3 = 0;
-    uint16_t m_ac4 = 0, m_ac5 = 0, m_ac6 = 0;
-    int16_t m_b1 = 0, m_b2 = 0, m_mb = 0, m_mc = 0, m_md = 0;
+        case State::Calibration:
+            m_compensation.setCalibration(m_buffer);
+            m_initialized = true;
+            startTemperature();
+            break;
 
-    // Polynomials
-    float m_fc5 = 0.0, m_fc6 = 0.0, m_fmc = 0.0, m_fmd = 0.0;
-    float m_fx0 = 0.0, m_fx1 = 0.0, m_fx2 = 0.0;
-    float m_fy0 = 0.0, m_fy1 = 0.0, m_fy2 = 0.0;
-    float m_fp0 = 0.0, m_fp1 = 0.0, m_fp2 = 0.0;
+        case State::StartTemperature:
+            startWaiting(State::WaitTemperature);
+            break;
+
+        case State::WaitTemperature:
+            if (!isElapsed(c_temperatureTime))
+                return false;
+            m_state = State::CheckTemperature;
+            readRegisters(c_controlRegister, m_buffer, 1);
+            break;
+
+        case State::CheckTemperature:
+            if (Sensors::bitRead(m_buffer[0], c_conversionBit)) {
+                readRegisters(c_controlRegister, m_buffer, 1);
+            } else {
+                m_state = State::ReadTemperature;
+                readRegisters(c_dataRegister, m_buffer, 2);
+            }
+            break;
+
+        case State::ReadTemperature:
+            m_rawTemperature = Sensors::word(m_buffer[0], m_buffer[1]);
+            m_state = State::StartPressure;
+            writeRegister(c_controlRegister,
+                          c_measurePressureCmd | (oversampling() << 6));
+            break;
+
+        case State::StartPressure:
+            startWaiting(State::WaitPressure);
+            break;
+
+        case State::WaitPressure:
+            if (!isElapsed(pressureTime()))
+                return false;
+            m_state = State::CheckPressure;
+            readRegisters(c_controlRegister, m_buffer, 1);
+            break;
+
+        case State::CheckPressure:
+            if (Sensors::bitRead(m_buffer[0], c_conversionBit)) {
+                readRegisters(c_controlRegister, m_buffer, 1);
+            } else {
+                m_state = State::ReadPressure;
+                readRegisters(c_dataRegister, m_buffer, 3);
+            }
+            break;
+
+        case State::ReadPressure:
+            m_compensation.calculate(
+                        m_rawTemperature,
+                        (static_cast<uint32_t>(m_buffer[0]) << 16) |
+                        (static_cast<uint32_t>(m_buffer[1]) << 8) | m_buffer[2],
+                        oversampling());
+            m_valid = true;
+            m_status = TwiStatus::Complete;
+            break;
+        }
+        return true;
+    }
 
-    void readCalibration()
+    void startWaiting(State state)
     {
-        m_ac1 = readUInt16(c_ac1Register);
-        m_ac2 = readUInt16(c_ac2Register);
-        m_ac3 = readUInt16(c_ac3Register);
-        m_ac4 = readUInt16(c_ac4Register);
-        m_ac5 = readUInt16(c_ac5Register);
-        m_ac6 = readUInt16(c_ac6Register);
-        m_b1  = readUInt16(c_b1Register);
-        m_b2  = readUInt16(c_b2Register);
-        m_mb  = readUInt16(c_mbRegister);
-        m_mc  = readUInt16(c_mcRegister);
-        m_md  = readUInt16(c_mdRegister);
+        m_state = state;
+        m_conversionStart = SystemClock::instance().millis();
     }
 
-    void calculatePolynomials()
+    // The first millisecond may be partial, so one more has to elapse
+    bool isElapsed(uint8_t conversionTime) const
     {
-        float fc3, fc4, fb1;
-        fc3 = 160.0 * pow(2, -15) * m_ac3;
-        fc4 = pow(10, -3) * pow(2, -15) * m_ac4;
-        fb1 = pow(160, 2) * pow(2, -30) * m_b1;
-
-        // For temperature
-        m_fc5 = (pow(2, -15) / 160) * m_ac5;
-        m_fc6 = m_ac6;
-        m_fmc = (pow(2, 11) / pow(160, 2)) * m_mc;
-        m_fmd = m_md / 160.0;
-
-        // For pressure
-        m_fx0 = m_ac1;
-        m_fx1 = 160.0 * pow(2, -13) * m_ac2;
-        m_fx2 = pow(160, 2) * pow(2, -25) * m_b2;
-        m_fy0 = fc4 * pow(2, 15);
-        m_fy1 = fc4 * fc3;
-        m_fy2 = fc4 * fb1;
-        m_fp0 = (3791.0 - 8.0) / 1600.0;
-        m_fp1 = 1.0 - 7357.0 * pow(2, -20);
-        m_fp2 = 3038.0 * 100.0 * pow(2, -36);
+        return SystemClock::instance().millis() - m_conversionStart >
+               conversionTime;
     }
 
-    uint16_t readTemperature()
+    void startTemperature()
     {
-        writeUInt8(c_controlRegister, c_measureTempCmd);
-        _delay_ms(5);
-        return readUInt16(c_dataRegister);
+        m_state = State::StartTemperature;
+        writeRegister(c_controlRegister, c_measureTempCmd);
     }
 
-    uint32_t readPressure()
+    uint8_t oversampling() const
     {
         switch (m_mode) {
         case Mode::UltraLowPower:
-            writeUInt8(c_controlRegister, c_measurePressure0);
-            _delay_ms(5);
-            break;
+            return 0;
         case Mode::Standard:
-            writeUInt8(c_controlRegister, c_measurePressure1);
-            _delay_ms(8);
-            break;
+            return 1;
         case Mode::HighResolution:
-            writeUInt8(c_controlRegister, c_measurePressure2);
-            _delay_ms(14);
-            break;
+            return 2;
         case Mode::UltraHighResolution:
-            writeUInt8(c_controlRegister, c_measurePressure3);
-            _delay_ms(26);
-            break;
+        default:
+            return 3;
         }
+    }
 
-        uint16_t msb = readUInt16(c_dataRegister);
-        uint8_t lsb = readUInt8(c_dataRegister + 2);
-        return (static_cast<uint32_t>(msb) << 8) | lsb;
+    // Maximum pressure conversion time (in ms, rounded up)
+    uint8_t pressureTime() const
+    {
+        switch (m_mode) {
+        case Mode::UltraLowPower:
+            return 5;   // 4.5 ms
+        case Mode::Standard:
+            return 8;   // 7.5 ms
+        case Mode::HighResolution:
+            return 14;  // 13.5 ms
+        case Mode::UltraHighResolution:
+        default:
+            return 26;  // 25.5 ms
+        }
     }
 
-    void writeUInt8(uint8_t reg, uint8_t value)
+    void writeRegister(uint8_t reg, uint8_t value)
     {
-        auto i2c = Avr::I2c::instance();
-        i2c.beginTransmission(c_address);
-        i2c.write(reg);
-        i2c.write(value);
-        i2c.endTransmission();
+        m_buffer[0] = reg;
+        m_buffer[1] = value;
+        m_transaction.setup(c_address, m_buffer, 2);
+        submit();
     }
 
-    uint8_t readUInt8(uint8_t reg)
+    // Reads \p length consecutive registers starting at \p reg
+    void readRegisters(uint8_t reg, uint8_t *data, uint8_t length)
     {
-        auto i2c = Avr::I2c::instance();
-        i2c.beginTransmission(c_address);
-        i2c.write(reg);
-        i2c.endTransmission();
-
-        uint8_t result = 0;
-        if (i2c.requestFrom(c_address, 1) == 1) {
-            result = i2c.read();
-        }
-        return result;
+        m_register = reg;
+        m_transaction.setup(c_address, &m_register, 1, data, length);
+        submit();
     }
 
-    uint16_t readUInt16(uint8_t reg)
+    void submit()
     {
-        auto i2c = Avr::I2c::instance();
-        i2c.beginTransmission(c_address);
-        i2c.write(reg);
-        i2c.endTransmission();
-
-        uint16_t result = 0;
-        if (i2c.requestFrom(c_address, 2) == 2) {
-            uint8_t msb = i2c.read();
-            uint8_t lsb = i2c.read();
-            result = Sensors::word(msb, lsb);
-        }
-        return result;
+        if (!Twi::instance().submit(m_transaction))
+            m_status = TwiStatus::Error;
     }
 };
 
@@ -33,6 +33,8 @@
  * \copydoc libtarget_dht22
  */
 
+#include "lib/dht22sensor.h"
+#include "lib/fixedpoint.h"
 #include "lib/utils.h"
 
 #include "pin.h"
@@ -71,7 +73,7 @@ public:
      *
      * \return The cached temperature value.
      */
-    float temperature() const {
+    Sensors::SensorValue temperature() const {
         return m_temperature;
     }
 
@@ -82,7 +84,7 @@ public:
      *
      * \return The cached humidity value.
      */
-    float humidity() const {
+    Sensors::SensorValue humidity() const {
         return m_humidity;
     }
 
@@ -132,14 +134,11 @@ public:
         m_pin.setOutput();
         m_pin.on();
 
-        // Parse sensor data. The High most temperature bit indicates negative
-        // temperature.
-        m_humidity = Sensors::word(bits[0], bits[1]) / 10.0;
-        m_temperature = Sensors::word(bits[2] & 0x7F, bits[3]) / 10.0;
-        if (Sensors::bitRead(bits[2], 7)) m_temperature = -m_temperature;
-
-        // Verify checksum.
-        m_valid = ((uint8_t)(bits[0] + bits[1] + bits[2] + bits[3]) == bits[4]);
+        Sensors::Dht22Sensor sensor;
+        m_valid = sensor.setData(bits, sizeof(bits)) ==
+                  Sensors::SensorStatus::Complete;
+        m_temperature = sensor.temperature();
+        m_humidity = sensor.humidity();
         return m_valid;
     }
 
@@ -148,8 +147,8 @@ private:
 
     TPin m_pin;
     bool m_valid = false;
-    float m_temperature = 0.0F;
-    float m_humidity = 0.0F;
+    Sensors::SensorValue m_temperature;
+    Sensors::SensorValue m_humidity;
 
     bool waitForEdge(bool edge, uint16_t timeout = c_timeout) {
         uint16_t cycle = 0;
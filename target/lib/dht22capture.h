@@ -0,0 +1,344 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#pragma once
+
+/*!
+ * \defgroup libtarget_dht22capture DHT22 interrupt driven reader
+ * \ingroup libtarget
+ *
+ * \brief Avr::Dht22Capture reads DHT22 / AM2302 sensors in the background
+ *        using a pin change interrupt and Timer2.
+ *
+ * In contrast to Avr::Dht22, which busy-waits for about 5 ms while the
+ * sensor transmits its data, Avr::Dht22Capture measures the width of the
+ * high pulses from the interrupt service routines. The main loop only starts
+ * the measurement and checks for its completion.
+ */
+
+/*!
+ * \file
+ * \ingroup libtarget_dht22capture
+ * \copydoc libtarget_dht22capture
+ */
+
+#include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "lib/dht22sensor.h"
+#include "lib/fixedpoint.h"
+#include "lib/utils.h"
+
+#include "interrupt.h"
+#include "pin.h"
+#include "timer.h"
+#include "trace.h"
+
+#ifndef F_CPU
+#error "F_CPU not defined for dht22capture.h"
+#endif
+
+namespace Avr
+{
+
+/*!
+ * \addtogroup libtarget_dht22capture
+ * \{
+ */
+
+/*!
+ * \brief Status of an Avr::Dht22Capture measurement.
+ */
+enum class Dht22Status : uint8_t {
+    /*!
+     * No measurement has been started.
+     */
+    Idle = 0,
+
+    /*!
+     * The measurement is in progress.
+     */
+    Pending,
+
+    /*!
+     * The measurement has been completed and the checksum is valid.
+     */
+    Complete,
+
+    /*!
+     * The received data is invalid (pulse width out of range or invalid
+     * checksum).
+     */
+    Error,
+
+    /*!
+     * The sensor didn't respond in time.
+     */
+    Timeout
+};
+
+namespace internal
+{
+
+/*!
+ * \brief Internal base class for Avr::Dht22Capture.
+ *
+ * Introduces the interrupt service routines for the pin change interrupt of
+ * port D (PCINT2) and the Timer2 overflow (see Avr::TimerInputCaptureBase
+ * for the rationale of the base class).
+ *
+ * \note This class cannot be used directly.
+ */
+class Dht22CaptureBase
+{
+    CLASS_IRQ(PinChangeInterrupt, PCINT2_vect);
+    CLASS_IRQ(TimerOverflowInterrupt, TIMER2_OVF_vect);
+
+protected:
+    static Dht22CaptureBase* s_baseInstance;
+
+private:
+    virtual void _pinChanged(uint8_t timestamp) = 0;
+    virtual void _timerOverflow() = 0;
+};
+Dht22CaptureBase *Dht22CaptureBase::s_baseInstance = nullptr;
+
+void Dht22CaptureBase::PinChangeInterrupt()
+{
+    uint8_t timestamp = TCNT2;
+    TRACE_SCOPE(Sensors::TraceEvent::PinChange);
+    s_baseInstance->_pinChanged(timestamp);
+}
+
+void Dht22CaptureBase::TimerOverflowInterrupt()
+{
+    s_baseInstance->_timerOverflow();
+}
+
+}  // namespace internal
+
+/*!
+ * \brief Reads DHT22 / AM2302 Temperature and humidity sensors without
+ *        blocking the main loop.
+ *
+ * The start signal is timed by a Timer2 overflow. Afterwards, the pin change
+ * interrupt timestamps every edge with the free running Timer2 and passes
+ * the width of each high pulse to a Sensors::Dht22Device. Timer2 and the pin
+ * change interrupt are only enabled while a measurement is in progress.
+ *
+ * Usage:
+ * \code
+ * Avr::Dht22Capture<PD2> dht22;
+ *
+ * int main() {
+ *     sei();
+ *     dht22.begin();
+ *     while (dht22.poll() == Avr::Dht22Status::Pending) {
+ *         // ...
+ *     }
+ *     if (dht22.isValid()) {
+ *         // ...
+ *     }
+ * }
+ * \endcode
+ *
+ * \note Only a single instance can be used because the interrupt service
+ *       routines are shared.
+ *
+ * \tparam pinNumber The pin of port D used to connect the sensor.
+ * \sa http://akizukidenshi.com/download/ds/aosong/AM2302.pdf
+ */
+template <uint8_t pinNumber>
+class Dht22Capture : private internal::Dht22CaptureBase
+{
+    static_assert(pinNumber < 8, "Invalid pin of port D");
+
+public:
+    Dht22Capture()
+    {
+        s_baseInstance = this;
+    }
+
+    /*!
+     * \brief Starts a new measurement.
+     *
+     * Does nothing if a measurement is already in progress.
+     */
+    void begin()
+    {
+        if (m_status == Dht22Status::Pending)
+            return;
+
+        m_device.reset();
+        m_fallingEdges = 0;
+        m_idleOverflows = 0;
+        m_status = Dht22Status::Pending;
+
+        // Request sample from sensor by setting the pin to low
+        // (T_be: min 0.8 ms, typ 1 ms, max 20 ms). The pin is released on the
+        // first timer overflow.
+        m_pin.setOutput();
+        m_pin.off();
+        m_starting = true;
+
+        TCCR2A = 0;
+        TCNT2 = 0;
+        Sensors::bitSet(TIFR2, TOV2);
+        Sensors::bitSet(TIMSK2, TOIE2);
+        TCCR2B = c_clockSelectStart;
+    }
+
+    /*!
+     * \brief Checks for the completion of the measurement.
+     *
+     * \return The status of the measurement.
+     */
+    Dht22Status poll() const
+    {
+        Dht22Status status = m_status;
+
+        // The decoder isn't modified by the interrupt service routines once
+        // the measurement is completed, but its data must not be read before
+        // the status.
+        __asm__ __volatile__("" ::: "memory");
+        return status;
+    }
+
+    /*!
+     * \brief Determines if the last measurement was valid.
+     *
+     * \return `true` if the last measurement was valid and temperature and
+     *         humidity can be read, `false` otherwise.
+     */
+    bool isValid() const { return poll() == Dht22Status::Complete; }
+
+    /*!
+     * \brief Retrieves the temperature value of the last measurement.
+     *
+     * \return The temperature value of the last measurement.
+     */
+    Sensors::SensorValue temperature() const {
+        return m_device.temperature();
+    }
+
+    /*!
+     * \brief Retrieves the humidity value of the last measurement.
+     *
+     * \return The humidity value of the last measurement.
+     */
+    Sensors::SensorValue humidity() const {
+        return m_device.humidity();
+    }
+
+private:
+    // Timer2 prescaler 64 for the start signal (1 ms at 16 MHz), prescaler 8
+    // while receiving so that the longest high pulse fits into 8 bit.
+    static const uint8_t c_clockSelectStart = (1 << CS22);
+    static const uint8_t c_clockSelectReceive = (1 << CS21);
+    static_assert(TimerUtils<8>::usToTicks<100>() < 256,
+                  "High pulses don't fit into Timer2 at prescaler 8");
+
+    // The sensor acknowledges with a low (T_rel) and a high (T_reh) pulse,
+    // the data bits end on the following falling edges.
+    static const uint8_t c_ackEdges = 2;
+
+    // Timer overflows without an edge until the measurement is aborted.
+    static const uint8_t c_timeoutOverflows = 3;
+
+    InputOutputPin<DigitalIoD, pinNumber> m_pin;
+    volatile Dht22Status m_status = Dht22Status::Idle;
+    volatile bool m_starting = false;
+    volatile uint8_t m_fallingEdges = 0;
+    volatile uint8_t m_idleOverflows = 0;
+    volatile uint8_t m_riseTimestamp = 0;
+    Sensors::Dht22Device<
+        TimerUtils<8>::usToTicks<10>(),   // Zero min
+        TimerUtils<8>::usToTicks<48>(),   // Zero max
+        TimerUtils<8>::usToTicks<48>(),   // One min
+        TimerUtils<8>::usToTicks<100>()   // One max
+        > m_device;
+
+    void stop()
+    {
+        TCCR2B = 0;
+        Sensors::bitClear(TIMSK2, TOIE2);
+        Sensors::bitClear(PCICR, PCIE2);
+        Sensors::bitClear(PCMSK2, pinNumber);
+
+        // Reset sensor.
+        m_pin.setOutput();
+        m_pin.on();
+    }
+
+    void _pinChanged(uint8_t timestamp)
+    {
+        m_idleOverflows = 0;
+        if (m_pin.isSet()) {
+            m_riseTimestamp = timestamp;
+            return;
+        }
+
+        if (m_fallingEdges < c_ackEdges) {
+            ++m_fallingEdges;
+            return;
+        }
+
+        uint8_t width = timestamp - m_riseTimestamp;
+        switch (m_device.addPulseWidth(width)) {
+        case Sensors::RfDeviceStatus::Incomplete:
+            break;
+        case Sensors::RfDeviceStatus::Complete:
+            stop();
+            m_status = Dht22Status::Complete;
+            break;
+        default:
+            stop();
+            m_status = Dht22Status::Error;
+            break;
+        }
+    }
+
+    void _timerOverflow()
+    {
+        if (m_starting) {
+            // Release the line (T_go) and wait for the sensor's response.
+            m_starting = false;
+            m_pin.on();
+            m_pin.setInput();
+
+            TCCR2B = c_clockSelectReceive;
+            TCNT2 = 0;
+            Sensors::bitSet(PCMSK2, pinNumber);
+            Sensors::bitSet(PCIFR, PCIF2);
+            Sensors::bitSet(PCICR, PCIE2);
+            return;
+        }
+
+        if (++m_idleOverflows >= c_timeoutOverflows) {
+            stop();
+            m_status = Dht22Status::Timeout;
+        }
+    }
+};
+
+/*! \} */  // \addtogroup libtarget_dht22capture
+
+}  // namespace Avr
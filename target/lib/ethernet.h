@@ -36,6 +36,9 @@
  */
 
 #include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
+#include <string.h>    // AVR toolchain doesn't offer cstring header
+
+#include "lib/flashstring.h"
 
 namespace Avr
 {
@@ -47,6 +50,33 @@ class Wiznet;
  * \{
  */
 
+/*!
+ * \brief Status of the asynchronous UDP transmission returned from
+ *        Ethernet::pollUdpStatus().
+ */
+enum class UdpStatus : uint8_t {
+    /*!
+     * No message has been transmitted yet.
+     */
+    Idle = 0,
+
+    /*!
+     * The last queued message is still being transmitted.
+     */
+    Busy,
+
+    /*!
+     * The last queued message has been sent.
+     */
+    Sent,
+
+    /*!
+     * The last queued message couldn't be sent because the destination
+     * didn't respond to ARP requests within the configured retry time.
+     */
+    Timeout
+};
+
 /*!
  * \brief Represents an Ethernet MAC address.
  */
@@ -129,7 +159,13 @@ private:
  *                 Avr::IpAddress(192.168, 0, 200),
  *                 Avr::IpAddress(255, 255, 0, 0));
  * auto dest = Avr::IpAddress(192, 168, 0, 100);
- * ethernet.sendUdpMessage("TEST\n", dest, 8600);
+ * ethernet.sendUdpMessage(dest, 8600, "TEST\n");
+ *
+ * // Non-blocking transmission
+ * ethernet.queueUdpMessage(dest, 8600, "TEST\n");
+ * while (ethernet.pollUdpStatus() == Avr::UdpStatus::Busy) {
+ *     // Do something else
+ * }
  * \endcode
  *
  * \tparam TDriver The driver for the Ethernet module to use.
@@ -171,6 +207,291 @@ public:
     {
         return TDriver::internalSendUdpMessage(dest, port, message);
     }
+
+    /*!
+     * \brief Queues an UDP message for transmission to the specified
+     *        destination and returns immediately.
+     *
+     * The progress of the transmission can be retrieved with
+     * pollUdpStatus(). Only one message can be transmitted at a time.
+     *
+     * \param dest The destination Avr::IpAddress to transmit the message to.
+     * \param port The destination UDP port number to transmit the message to.
+     * \param message The message to transmit.
+     *
+     * \return `true` if the message has been queued, `false` if the previous
+     *         message is still being transmitted or the driver reported an
+     *         error.
+     */
+    bool queueUdpMessage(IpAddress dest, uint16_t port, const char *message)
+    {
+        return TDriver::internalQueueUdpMessage(dest, port, message);
+    }
+
+    /*!
+     * \brief Appends \p data to the next UDP message without sending it.
+     *
+     * The data is copied into the transmit buffer of the Ethernet module.
+     * All data appended until sendUdpData() is called is sent as a single
+     * message.
+     *
+     * \param data The null-terminated data to append.
+     *
+     * \return `true` if the data has been appended, `false` if the previous
+     *         message is still being transmitted, the transmit buffer is
+     *         full or the driver reported an error.
+     */
+    bool appendUdpData(const char *data)
+    {
+        return appendUdpData(reinterpret_cast<const uint8_t *>(data),
+                             strlen(data));
+    }
+
+    /*!
+     * \brief Appends the null-terminated \p data from program memory to the
+     *        next UDP message without sending it.
+     *
+     * The data is transferred to the Ethernet module in small chunks, it is
+     * not copied into SRAM as a whole.
+     *
+     * \param data The data to append.
+     *
+     * \return `true` if the data has been appended, `false` if the previous
+     *         message is still being transmitted, the transmit buffer is
+     *         full or the driver reported an error.
+     */
+    bool appendUdpData(Sensors::FlashString data)
+    {
+        return TDriver::internalAppendUdpData(data);
+    }
+
+    /*!
+     * \brief Appends \p length bytes of binary \p data to the next UDP
+     *        message without sending it.
+     *
+     * \param data The data to append.
+     * \param length The number of bytes to append.
+     *
+     * \return `true` if the data has been appended, `false` if the previous
+     *         message is still being transmitted, the transmit buffer is
+     *         full or the driver reported an error.
+     *
+     * \sa appendUdpData(const char *)
+     */
+    bool appendUdpData(const uint8_t *data, uint16_t length)
+    {
+        return TDriver::internalAppendUdpData(data, length);
+    }
+
+    /*!
+     * \brief Sends the data appended with appendUdpData() as a single UDP
+     *        message to the specified destination and returns immediately.
+     *
+     * \param dest The destination Avr::IpAddress to transmit the message to.
+     * \param port The destination UDP port number to transmit the message to.
+     *
+     * \return `true` if the message has been queued, `false` if no data has
+     *         been appended or the previous message is still being
+     *         transmitted.
+     */
+    bool sendUdpData(IpAddress dest, uint16_t port)
+    {
+        return TDriver::internalSendUdpData(dest, port);
+    }
+
+    /*!
+     * \brief Retrieves the status of the last message queued with
+     *        queueUdpMessage() or sendUdpData().
+     *
+     * \return The status of the transmission.
+     */
+    UdpStatus pollUdpStatus()
+    {
+        return TDriver::internalPollUdpStatus();
+    }
+};
+
+/*!
+ * \brief Collects multiple messages into a single UDP datagram.
+ *
+ * Sending one datagram per measurement cycle instead of one per sensor saves
+ * protocol overhead and SPI transfers. The messages are appended directly to
+ * the transmit buffer of the Ethernet module, so no additional SRAM buffer is
+ * needed. Messages have to be delimited (JSON lines are newline terminated,
+ * binary frames end with a `0x00` byte) so that the receiver can split the
+ * datagram.
+ *
+ * Usage:
+ * \code
+ * Avr::UdpBatch<decltype(ethernet), 512> batch(ethernet, dest, 8600);
+ * batch.add("{\"dht22\":{\"temperature\":24.80}}\n");
+ * batch.add("{\"bmp180\":{\"pressure\":1013.25}}\n");
+ * batch.flush();
+ * \endcode
+ *
+ * \tparam TEthernet The Avr::Ethernet type.
+ * \tparam TThreshold The datagram is sent as soon as it reaches this size
+ *         (in bytes).
+ */
+template <typename TEthernet, uint16_t TThreshold>
+class UdpBatch
+{
+public:
+    /*!
+     * \brief Initializes an empty batch.
+     *
+     * \param ethernet The Ethernet interface used for sending.
+     * \param dest The destination Avr::IpAddress.
+     * \param port The destination UDP port number.
+     */
+    UdpBatch(TEthernet &ethernet, IpAddress dest, uint16_t port)
+        : m_ethernet(ethernet)
+        , m_dest(dest)
+        , m_port(port)
+    {
+    }
+
+    /*!
+     * \brief Determines if a previously sent datagram is still being
+     *        transmitted.
+     *
+     * Messages cannot be added while the Ethernet module is busy.
+     *
+     * \return `true` if the Ethernet module is busy, `false` otherwise.
+     */
+    bool isBusy()
+    {
+        return m_ethernet.pollUdpStatus() == UdpStatus::Busy;
+    }
+
+    /*!
+     * \brief Adds the \p message to the batch.
+     *
+     * The datagram is sent when it reaches the size threshold.
+     *
+     * \param message The null-terminated message.
+     * \return `true` if the message has been added, `false` if the Ethernet
+     *         module is busy or its transmit buffer is full.
+     */
+    bool add(const char *message)
+    {
+        return add(reinterpret_cast<const uint8_t *>(message),
+                   strlen(message));
+    }
+
+    /*!
+     * \brief Adds the \p message from program memory to the batch.
+     *
+     * The datagram is sent when it reaches the size threshold.
+     *
+     * \param message The message.
+     * \return `true` if the message has been added, `false` if the Ethernet
+     *         module is busy or its transmit buffer is full.
+     */
+    bool add(Sensors::FlashString message)
+    {
+        if (!m_ethernet.appendUdpData(message)) {
+            increment(m_dropped);
+            return false;
+        }
+
+        m_length += message.length();
+        if (m_length >= TThreshold)
+            flush();
+        return true;
+    }
+
+    /*!
+     * \brief Adds the binary \p message of \p length bytes to the batch.
+     *
+     * The datagram is sent when it reaches the size threshold.
+     *
+     * \param message The message.
+     * \param length The length of the message in bytes.
+     * \return `true` if the message has been added, `false` if the Ethernet
+     *         module is busy or its transmit buffer is full.
+     */
+    bool add(const uint8_t *message, uint16_t length)
+    {
+        if (!m_ethernet.appendUdpData(message, length)) {
+            increment(m_dropped);
+            return false;
+        }
+
+        m_length += length;
+        if (m_length >= TThreshold)
+            flush();
+        return true;
+    }
+
+    /*!
+     * \brief Sends all messages added since the last flush as one datagram.
+     *
+     * \return `true` if the batch is empty or the datagram has been queued
+     *         for transmission, `false` if the Ethernet module is busy.
+     */
+    bool flush()
+    {
+        if (m_length == 0)
+            return true;
+
+        // Each datagram is checked once, right before the next one is sent
+        if (m_ethernet.pollUdpStatus() == UdpStatus::Timeout)
+            increment(m_timeouts);
+        if (!m_ethernet.sendUdpData(m_dest, m_port))
+            return false;
+        m_length = 0;
+        return true;
+    }
+
+    /*!
+     * \brief Returns the number of messages that couldn't be added.
+     *
+     * The counter saturates at `UINT16_MAX`.
+     *
+     * \return The number of dropped messages.
+     */
+    uint16_t dropped() const
+    {
+        return m_dropped;
+    }
+
+    /*!
+     * \brief Returns the number of datagrams that couldn't be sent because
+     *        the destination didn't respond to ARP requests.
+     *
+     * The counter saturates at `UINT16_MAX`. The last sent datagram is only
+     * accounted for when the next datagram is sent.
+     *
+     * \return The number of timed out datagrams.
+     */
+    uint16_t timeouts() const
+    {
+        return m_timeouts;
+    }
+
+    /*!
+     * \brief Resets the dropped() and timeouts() counters.
+     */
+    void resetStatistics()
+    {
+        m_dropped = 0;
+        m_timeouts = 0;
+    }
+
+private:
+    static void increment(uint16_t &counter)
+    {
+        if (counter != UINT16_MAX)
+            ++counter;
+    }
+
+    TEthernet &m_ethernet;
+    IpAddress m_dest;
+    uint16_t m_port;
+    uint16_t m_length = 0;
+    uint16_t m_dropped = 0;
+    uint16_t m_timeouts = 0;
 };
 
 /*! \} */  // \addtogroup libtarget_ethernet
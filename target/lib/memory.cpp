@@ -0,0 +1,69 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "memory.h"
+
+#include <avr/io.h>
+
+// Symbols defined by the avr-libc linker scripts
+extern "C" uint8_t __data_start;
+extern "C" uint8_t __heap_start;
+
+namespace Avr
+{
+
+// Runs in .init3 after the stack pointer has been set up (.init2) and before
+// the static variables are initialized (.init4). Nothing is on the stack yet,
+// hence the memory up to RAMEND can be painted.
+__attribute__((naked, used, section(".init3")))
+static void paintStack()
+{
+    for (uint8_t *p = &__heap_start; p <= reinterpret_cast<uint8_t *>(RAMEND);
+            ++p) {
+        *p = Memory::c_paintPattern;
+    }
+}
+
+uint16_t Memory::staticSize()
+{
+    return &__heap_start - &__data_start;
+}
+
+uint16_t Memory::stackMax()
+{
+    return RAMEND + 1 - reinterpret_cast<uintptr_t>(&__heap_start) -
+           stackUnused();
+}
+
+uint16_t Memory::stackUnused()
+{
+    const uint8_t *p = &__heap_start;
+    while (p <= reinterpret_cast<const uint8_t *>(RAMEND) &&
+           *p == c_paintPattern) {
+        ++p;
+    }
+    return p - &__heap_start;
+}
+
+uint16_t Memory::free()
+{
+    return SP - reinterpret_cast<uintptr_t>(&__heap_start);
+}
+
+}  // namespace Avr
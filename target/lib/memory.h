@@ -0,0 +1,112 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#pragma once
+
+/*!
+ * \defgroup libtarget_memory Memory usage
+ * \ingroup libtarget
+ *
+ * \brief Avr::Memory reports the static RAM usage and the stack high-water
+ *        mark.
+ */
+
+/*!
+ * \file
+ * \ingroup libtarget_memory
+ * \copydoc libtarget_memory
+ */
+
+#include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
+
+namespace Avr
+{
+
+/*!
+ * \addtogroup libtarget_memory
+ * \{
+ */
+
+/*!
+ * \brief Static RAM usage and stack high-water mark.
+ *
+ * The SRAM is divided into the static variables (`.data`, `.bss` and
+ * `.noinit` sections) at the bottom and the stack growing down from the top.
+ * The heap is not used.
+ *
+ * During startup (before static variables are initialized), the memory
+ * between the static variables and the stack is painted with
+ * c_paintPattern. The deepest stack usage since reset is found by searching
+ * the first byte that has been overwritten.
+ *
+ * Usage:
+ * \code
+ * uart.sendValue("Stack max", Avr::Memory::stackMax());
+ * uart.sendValue("Stack unused", Avr::Memory::stackUnused());
+ * \endcode
+ *
+ * \note The painting code is only linked into the application if any of the
+ *       functions is used.
+ */
+class Memory
+{
+public:
+    /*!
+     * \brief Pattern the unused memory is painted with.
+     */
+    static const uint8_t c_paintPattern = 0xC5;
+
+    /*!
+     * \brief Returns the size of all static variables.
+     *
+     * \return The size of the `.data`, `.bss` and `.noinit` sections (in
+     *         bytes).
+     */
+    static uint16_t staticSize();
+
+    /*!
+     * \brief Returns the maximum stack usage since reset (high-water mark).
+     *
+     * \return The maximum stack usage (in bytes).
+     */
+    static uint16_t stackMax();
+
+    /*!
+     * \brief Returns the memory that has never been used by the stack since
+     *        reset.
+     *
+     * This is the headroom left for additional static variables (e.g.
+     * sensors or queue slots).
+     *
+     * \return The unused memory (in bytes).
+     */
+    static uint16_t stackUnused();
+
+    /*!
+     * \brief Returns the memory between the static variables and the current
+     *        stack pointer.
+     *
+     * \return The currently free memory (in bytes).
+     */
+    static uint16_t free();
+};
+
+/*! \} */  // \addtogroup libtarget_memory
+
+}  // namespace Avr
@@ -33,9 +33,10 @@
  * \copydoc libtarget_mlx90614
  */
 
+#include "lib/fixedpoint.h"
 #include "lib/utils.h"
 
-#include "lib/i2c.h"
+#include "twi.h"
 
 namespace Avr
 {
@@ -68,7 +69,7 @@ public:
      *
      * \return The cached ambient temperature value.
      */
-    float ambientTemperature() const {
+    Sensors::SensorValue ambientTemperature() const {
         return m_ambientTemperature;
     }
 
@@ -79,69 +80,127 @@ public:
      *
      * \return The cached object temperature value.
      */
-    float objectTemperature() const {
+    Sensors::SensorValue objectTemperature() const {
         return m_objectTemperature;
     }
 
+    /*!
+     * \brief Starts reading the ambient and object temperature from the
+     *        sensor.
+     *
+     * The transfer is processed by Avr::Twi in the background. Its
+     * completion has to be checked with poll().
+     *
+     * \return `true` if the transfer has been started, `false` if a transfer
+     *         is still pending or couldn't be queued.
+     */
+    bool begin()
+    {
+        if (m_status == TwiStatus::Pending)
+            return false;
+
+        m_valid = false;
+        m_status = TwiStatus::Pending;
+        m_register = c_ambientTemperatureAddress;
+        submit();
+        return m_status == TwiStatus::Pending;
+    }
+
+    /*!
+     * \brief Checks for the completion of the transfer started with
+     *        begin() and updates the cached values.
+     *
+     * \return TwiStatus::Pending while the transfer is running,
+     *         TwiStatus::Complete if the values have been updated and
+     *         TwiStatus::Error if an error occurred when accessing the
+     *         sensor.
+     */
+    TwiStatus poll()
+    {
+        if (m_status != TwiStatus::Pending || m_transaction.isPending())
+            return m_status;
+
+        uint16_t value;
+        if (m_transaction.status() != TwiStatus::Complete ||
+                !decode(&value)) {
+            m_status = TwiStatus::Error;
+            return m_status;
+        }
+
+        if (m_register == c_ambientTemperatureAddress) {
+            m_ambientTemperature = toCelsius(value);
+            m_register = c_objectTemperatureAddress;
+            submit();
+        } else {
+            m_objectTemperature = toCelsius(value);
+            m_valid = true;
+            m_status = TwiStatus::Complete;
+        }
+        return m_status;
+    }
+
     /*!
      * \brief Reads the ambient and object temperature from the sensor and
      *        updates the cached values.
+     *
+     * Blocks until the transfer is completed (see begin() and poll()).
+     *
      * \return `true` if the sensor data could be read, `false` if an error
      *         occurred when accessing the sensor.
      */
     bool read()
     {
-        bool status;
-        m_valid = true;
-
-        m_ambientTemperature = read(c_ambientTemperatureAddress, &status)
-                * c_resolution - c_zeroCinK;
-        if (!status)
-            m_valid = false;
-
-        m_objectTemperature = read(c_objectTemperatureAddress, &status)
-                * c_resolution - c_zeroCinK;
-        if (!status)
-            m_valid = false;
+        if (!begin())
+            return false;
 
+        while (poll() == TwiStatus::Pending) {}
         return m_valid;
     }
 
 private:
-    static constexpr float c_resolution = 0.02F;
-    static constexpr float c_zeroCinK = 273.15F;
+    // Resolution (0.02 K) and 0 °C (273.15 K) in 1/100 K.
+    static const uint8_t c_resolution = 2;
+    static const int32_t c_zeroCinK = 27315;
     static const uint8_t c_deviceAddress = 0x5A;
     static const uint8_t c_ambientTemperatureAddress = 0x06;
     static const uint8_t c_objectTemperatureAddress = 0x07;
 
     bool m_valid = false;
-    float m_ambientTemperature = 0.0F;
-    float m_objectTemperature = 0.0F;
+    TwiStatus m_status = TwiStatus::Idle;
+    Sensors::SensorValue m_ambientTemperature;
+    Sensors::SensorValue m_objectTemperature;
+
+    TwiTransaction m_transaction;
+    uint8_t m_register = 0;
+    uint8_t m_buffer[3];
 
-    uint16_t read(uint8_t reg, bool *status)
+    static Sensors::SensorValue toCelsius(uint16_t value)
     {
-        auto i2c = Avr::I2c::instance();
-        i2c.beginTransmission(c_deviceAddress);
-        i2c.write(reg);
-        i2c.endTransmission(false);
-
-        uint8_t bytesRead = i2c.requestFrom(c_deviceAddress, 3);
-        uint16_t value = 0;
-        if (bytesRead == 3) {
-            uint8_t lsb = i2c.read();
-            uint8_t msb = i2c.read();
-
-            // Bit 7 set indicates error
-            if (!Sensors::bitRead(msb, 7)) {
-                value = Sensors::word(msb & 0x7F, lsb);
-                if (status) *status = true;
-            } else {
-                if (status) *status = false;
-            }
-        } else {
-            if (status) *status = false;
-        }
-        return value;
+        static_assert(Sensors::SensorValue::scale() == 100,
+                      "Constants are defined in 1/100 K.");
+        return Sensors::SensorValue::fromRaw(
+                    static_cast<int32_t>(value) * c_resolution - c_zeroCinK);
+    }
+
+    void submit()
+    {
+        m_transaction.setup(c_deviceAddress, &m_register, 1,
+                            m_buffer, sizeof(m_buffer));
+        if (!Twi::instance().submit(m_transaction))
+            m_status = TwiStatus::Error;
+    }
+
+    bool decode(uint16_t *value) const
+    {
+        uint8_t lsb = m_buffer[0];
+        uint8_t msb = m_buffer[1];
+
+        // Bit 7 set indicates error
+        if (Sensors::bitRead(msb, 7))
+            return false;
+
+        *value = Sensors::word(msb & 0x7F, lsb);
+        return true;
     }
 };
 
@@ -0,0 +1,282 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#pragma once
+
+/*!
+ * \defgroup libtarget_outputsink Output sinks
+ * \ingroup libtarget
+ *
+ * \brief Avr::UartSink and Avr::UdpSink queue formatted messages and
+ *        transmit them without blocking the code producing the messages.
+ *
+ * Messages are formatted into a buffer on the stack and copied into the
+ * queue of each enabled sink. The next message can be formatted while the
+ * previous ones are still being transmitted. Each sink is drained
+ * independently, so a slow output does not delay the others.
+ */
+
+/*!
+ * \file
+ * \ingroup libtarget_outputsink
+ * \copydoc libtarget_outputsink
+ */
+
+#include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
+
+#include "lib/messagequeue.h"
+
+#include "systemclock.h"
+#include "uart.h"
+
+namespace Avr
+{
+
+/*!
+ * \addtogroup libtarget_outputsink
+ * \{
+ */
+
+/*!
+ * \brief Queues messages for transmission over Avr::Uart.
+ *
+ * drain() only hands over as many bytes as the UART transmitted since the
+ * previous call, so the send buffer of the UART never runs full and
+ * transmitting never waits. Messages that do not fit into the queue are
+ * dropped.
+ *
+ * Usage:
+ * \code
+ * Avr::UartSink<9600, 256> sink;
+ *
+ * void send(const uint8_t *message, uint8_t length) {
+ *     sink.add(message, length);
+ * }
+ *
+ * int main() {
+ *     while (true) {
+ *         sink.drain();  // At least every few milliseconds
+ *     }
+ * }
+ * \endcode
+ *
+ * \tparam baud The baud rate of the Avr::Uart.
+ * \tparam TQueueSize Capacity of the queue (in bytes).
+ */
+template <uint16_t baud, uint16_t TQueueSize>
+class UartSink
+{
+public:
+    /*!
+     * \brief Queues \p length bytes of \p data for transmission.
+     *
+     * \param data The message.
+     * \param length The number of bytes of the message.
+     * \return `true` if the message has been queued, `false` if it has been
+     *         dropped.
+     */
+    bool add(const uint8_t *data, uint16_t length)
+    {
+        return m_queue.push(data, length);
+    }
+
+    /*!
+     * \brief Passes queued bytes to the UART as far as it can take them
+     *        without waiting.
+     */
+    void drain()
+    {
+        uint32_t now = SystemClock::instance().millis();
+        uint32_t elapsed = now - m_last;
+        m_last = now;
+        if (elapsed > 1000)
+            elapsed = 1000;  // Avoids overflows, the credit is capped anyway
+
+        uint32_t bits = m_bits + elapsed * baud / 1000;
+        m_bits = bits > c_maxBits ? c_maxBits : bits;
+
+        auto &uart = Uart<baud>::instance();
+        uint8_t byte;
+        while (m_bits >= c_bitsPerByte && m_queue.pop(byte)) {
+            uart.sendChar(byte);
+            m_bits -= c_bitsPerByte;
+        }
+    }
+
+    /*!
+     * \brief Determines if all queued messages have been passed to the
+     *        UART.
+     *
+     * \return `true` if the queue is empty, `false` otherwise.
+     */
+    bool isEmpty() const
+    {
+        return m_queue.isEmpty();
+    }
+
+    /*!
+     * \brief Returns the number of dropped messages.
+     *
+     * \return The number of dropped messages.
+     */
+    uint16_t dropped() const
+    {
+        return m_queue.dropped();
+    }
+
+    /*!
+     * \brief Resets the number of dropped messages.
+     */
+    void resetStatistics()
+    {
+        m_queue.resetDropped();
+    }
+
+private:
+    // Start bit, 8 data bits and stop bit
+    static const uint8_t c_bitsPerByte = 10;
+    // Bytes passed at once, well below the send buffer size of avr-uart
+    static const uint8_t c_maxBurst = 16;
+    static const uint16_t c_maxBits = c_maxBurst * c_bitsPerByte;
+
+    Sensors::MessageQueue<TQueueSize> m_queue;
+    uint32_t m_last = 0;
+    uint16_t m_bits = 0;
+};
+
+/*!
+ * \brief Queues messages for an Avr::UdpBatch while a previous datagram is
+ *        being transmitted.
+ *
+ * Messages are added to the batch right away if it accepts messages and
+ * nothing is queued. Otherwise they are queued until drain() is called
+ * after the transmission has completed. If the queue is full, the oldest
+ * messages are dropped by default.
+ *
+ * \tparam TBatch The Avr::UdpBatch type.
+ * \tparam TQueueSize Capacity of the queue (in bytes).
+ * \tparam TMessageSize Maximum length of a message (in bytes). drain()
+ *         allocates a buffer of this size on the stack.
+ * \tparam TPolicy Policy for dropping messages if the queue is full.
+ */
+template <typename TBatch, uint16_t TQueueSize, uint8_t TMessageSize,
+          Sensors::DropPolicy TPolicy = Sensors::DropPolicy::DropOldest>
+class UdpSink
+{
+public:
+    /*!
+     * \brief Initializes an empty sink.
+     *
+     * \param batch The UDP batch the messages are added to.
+     */
+    explicit UdpSink(TBatch &batch)
+        : m_batch(batch)
+    {
+    }
+
+    /*!
+     * \brief Adds \p length bytes of \p data to the batch or queues them.
+     *
+     * \param data The message.
+     * \param length The number of bytes of the message.
+     * \return `true` if the message has been added or queued, `false` if it
+     *         has been dropped.
+     */
+    bool add(const uint8_t *data, uint16_t length)
+    {
+        if (m_queue.isEmpty() && !m_batch.isBusy())
+            return m_batch.add(data, length);
+        return m_queue.push(data, length);
+    }
+
+    /*!
+     * \brief Adds queued messages to the batch until the queue is empty or
+     *        the batch is being sent.
+     */
+    void drain()
+    {
+        uint8_t message[TMessageSize];
+        while (!m_queue.isEmpty() && !m_batch.isBusy()) {
+            uint8_t length = m_queue.pop(message, TMessageSize);
+            if (length > 0)
+                m_batch.add(message, length);
+        }
+    }
+
+    /*!
+     * \brief Determines if queued messages can be added to the batch.
+     *
+     * \return `true` if messages are queued and the batch accepts them,
+     *         `false` otherwise.
+     */
+    bool isReady()
+    {
+        return !m_queue.isEmpty() && !m_batch.isBusy();
+    }
+
+    /*!
+     * \brief Determines if no messages are queued.
+     *
+     * \return `true` if the queue is empty, `false` otherwise.
+     */
+    bool isEmpty() const
+    {
+        return m_queue.isEmpty();
+    }
+
+    /*!
+     * \brief Returns the number of messages dropped by the queue.
+     *
+     * Messages dropped by the batch are counted by TBatch::dropped().
+     *
+     * \return The number of dropped messages.
+     */
+    uint16_t dropped() const
+    {
+        return m_queue.dropped();
+    }
+
+    /*!
+     * \brief Resets the number of messages dropped by the queue.
+     *
+     * The counters of the batch are reset by TBatch::resetStatistics().
+     */
+    void resetStatistics()
+    {
+        m_queue.resetDropped();
+    }
+
+    /*!
+     * \brief Returns the UDP batch.
+     *
+     * \return The UDP batch.
+     */
+    TBatch &batch()
+    {
+        return m_batch;
+    }
+
+private:
+    TBatch &m_batch;
+    Sensors::MessageQueue<TQueueSize, TPolicy> m_queue;
+};
+
+/*! \} */  // \addtogroup libtarget_outputsink
+
+}  // namespace Avr
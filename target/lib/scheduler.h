@@ -0,0 +1,297 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#pragma once
+
+/*!
+ * \defgroup libtarget_scheduler Cooperative scheduler
+ * \ingroup libtarget
+ *
+ * \brief Avr::Scheduler runs tasks with individual periods from the main
+ *        loop.
+ */
+
+/*!
+ * \file
+ * \ingroup libtarget_scheduler
+ * \copydoc libtarget_scheduler
+ */
+
+#include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
+
+#include "systemclock.h"
+#include "trace.h"
+
+namespace Avr
+{
+
+/*!
+ * \addtogroup libtarget_scheduler
+ * \{
+ */
+
+/*!
+ * \brief Runtime statistics of a task managed by Avr::Scheduler.
+ *
+ * All counters saturate instead of wrapping around.
+ */
+struct TaskStatistics
+{
+    /*!
+     * \brief Number of times the task has been run.
+     */
+    uint16_t runs = 0;
+
+    /*!
+     * \brief Number of runs that started after the task's deadline.
+     */
+    uint16_t deadlineMisses = 0;
+
+    /*!
+     * \brief Longest runtime (in us).
+     */
+    uint16_t maxRuntime = 0;
+
+    /*!
+     * \brief Accumulated runtime of all runs (in us).
+     */
+    uint32_t totalRuntime = 0;
+
+    /*!
+     * \brief Returns the average runtime (in us).
+     *
+     * \return The average runtime (in us).
+     */
+    uint16_t averageRuntime() const
+    {
+        return runs ? totalRuntime / runs : 0;
+    }
+};
+
+/*!
+ * \brief Cooperative scheduler for periodic and event driven tasks.
+ *
+ * Tasks are plain functions that are run to completion from the main loop.
+ * A task becomes due once its period has elapsed. An optional readiness
+ * callback can delay the task until for example a measurement is completed.
+ * Tasks with a period of `0` are purely event driven and run whenever their
+ * readiness callback returns `true`.
+ *
+ * If multiple tasks are runnable, the task with the earliest deadline is run
+ * first. The deadline defaults to the period of the task. Runs that start
+ * after the deadline are counted as deadline misses.
+ *
+ * Usage:
+ * \code
+ * static void blink() { ... }
+ * static bool measurementDone() { ... }
+ * static void output() { ... }
+ *
+ * Avr::Scheduler<4> scheduler;
+ *
+ * int main() {
+ *     sei();
+ *     scheduler.add(blink, 500);
+ *     scheduler.add(output, 0, 10, measurementDone);
+ *     while (true) {
+ *         scheduler.runOnce();
+ *     }
+ * }
+ * \endcode
+ *
+ * \note Tasks are scheduled with a resolution of 1 ms based on
+ *       Avr::SystemClock.
+ *
+ * \tparam TCapacity Maximum number of tasks.
+ */
+template <uint8_t TCapacity>
+class Scheduler
+{
+public:
+    /*!
+     * \brief Function executed by a task.
+     */
+    using Function = void (*)();
+
+    /*!
+     * \brief Readiness callback of a task.
+     */
+    using Ready = bool (*)();
+
+    /*!
+     * \brief Task index returned by add() if no more tasks can be added.
+     */
+    static const uint8_t c_invalidTask = 0xFF;
+
+    /*!
+     * \brief Adds a task that is due after \p offset.
+     *
+     * \param function The function to run.
+     * \param period The period (in ms). `0` for event driven tasks.
+     * \param deadline Maximum delay (in ms) between the task becoming
+     *        due and its start. `0` to use \p period as deadline. For event
+     *        driven tasks, the deadline only determines the priority.
+     * \param ready Optional readiness callback. Required for event driven
+     *        tasks.
+     * \param offset Delay (in ms) of the first run. Tasks with the same
+     *        period keep their offset to each other, which spreads their
+     *        load. Ignored for event driven tasks.
+     * \return The index of the task (used for statistics()) or
+     *         c_invalidTask if the scheduler is full.
+     */
+    uint8_t add(Function function, uint16_t period, uint16_t deadline = 0,
+                Ready ready = nullptr, uint16_t offset = 0)
+    {
+        if (m_size == TCapacity || (period == 0 && !ready))
+            return c_invalidTask;
+
+        Task &task = m_tasks[m_size];
+        task.function = function;
+        task.ready = ready;
+        task.period = period;
+        task.deadline = deadline ? deadline : period;
+        task.due = SystemClock::instance().millis() + offset;
+        return m_size++;
+    }
+
+    /*!
+     * \brief Runs the runnable task with the earliest deadline.
+     *
+     * \return `true` if a task has been run, `false` if no task was
+     *         runnable.
+     */
+    bool runOnce()
+    {
+        uint32_t now = SystemClock::instance().millis();
+
+        Task *next = nullptr;
+        uint32_t nextDeadline = 0;
+        for (uint8_t index = 0; index < m_size; ++index) {
+            Task &task = m_tasks[index];
+            if (task.period != 0 && static_cast<int32_t>(now - task.due) < 0)
+                continue;
+            if (task.ready && !task.ready())
+                continue;
+
+            // Event driven tasks become runnable when they are ready
+            uint32_t due = task.period ? task.due : now;
+            uint32_t deadline = due + task.deadline;
+            if (!next || static_cast<int32_t>(deadline - nextDeadline) < 0) {
+                next = &task;
+                nextDeadline = deadline;
+            }
+        }
+
+        if (!next)
+            return false;
+
+        run(*next, now, nextDeadline);
+        return true;
+    }
+
+    /*!
+     * \brief Returns the number of tasks.
+     *
+     * \return The number of tasks.
+     */
+    uint8_t size() const
+    {
+        return m_size;
+    }
+
+    /*!
+     * \brief Returns the runtime statistics of the task with the given
+     *        \p index.
+     *
+     * \param index The index of the task as returned by add().
+     * \return The runtime statistics of the task.
+     */
+    const TaskStatistics &statistics(uint8_t index) const
+    {
+        return m_tasks[index].statistics;
+    }
+
+    /*!
+     * \brief Resets the runtime statistics of the task with the given
+     *        \p index.
+     *
+     * \param index The index of the task as returned by add().
+     */
+    void resetStatistics(uint8_t index)
+    {
+        m_tasks[index].statistics = TaskStatistics();
+    }
+
+    /*!
+     * \brief Resets the runtime statistics of all tasks.
+     */
+    void resetStatistics()
+    {
+        for (uint8_t index = 0; index < m_size; ++index) {
+            m_tasks[index].statistics = TaskStatistics();
+        }
+    }
+
+private:
+    struct Task
+    {
+        Function function = nullptr;
+        Ready ready = nullptr;
+        uint16_t period = 0;
+        uint16_t deadline = 0;
+        uint32_t due = 0;
+        TaskStatistics statistics;
+    };
+
+    Task m_tasks[TCapacity];
+    uint8_t m_size = 0;
+
+    void run(Task &task, uint32_t now, uint32_t deadline)
+    {
+        auto &clock = SystemClock::instance();
+        uint32_t start = clock.micros();
+        {
+            TRACE_SCOPE(static_cast<uint8_t>(Sensors::TraceEvent::Task) +
+                        (&task - m_tasks));
+            task.function();
+        }
+        uint32_t runtime = clock.micros() - start;
+
+        TaskStatistics &statistics = task.statistics;
+        if (statistics.runs != UINT16_MAX)
+            ++statistics.runs;
+        if (static_cast<int32_t>(now - deadline) > 0 &&
+                statistics.deadlineMisses != UINT16_MAX)
+            ++statistics.deadlineMisses;
+        if (runtime > statistics.maxRuntime)
+            statistics.maxRuntime = runtime > UINT16_MAX ? UINT16_MAX :
+                                                           runtime;
+        if (statistics.totalRuntime <= UINT32_MAX - runtime)
+            statistics.totalRuntime += runtime;
+
+        // Keep the period stable, skip runs that have been missed entirely
+        task.due += task.period;
+        if (static_cast<int32_t>(now - task.due) >= 0)
+            task.due = now + task.period;
+    }
+};
+
+/*! \} */  // \addtogroup libtarget_scheduler
+
+}  // namespace Avr
@@ -0,0 +1,72 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "sleep.h"
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+#include "lib/utils.h"
+
+#include "systemclock.h"
+
+namespace Avr
+{
+
+Sleep Sleep::s_instance;
+
+void Sleep::idle()
+{
+    if (!Sensors::bitRead(SREG, SREG_I))
+        return;
+
+    auto &clock = SystemClock::instance();
+    uint32_t start = clock.micros();
+
+    // Interrupts are enabled with the instruction following sei, so an
+    // interrupt occurring before sleep_cpu() still wakes the CPU.
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    cli();
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+
+    m_sleepTime += clock.micros() - start;
+}
+
+uint32_t Sleep::sleepTime() const
+{
+    return m_sleepTime / 1000;
+}
+
+uint32_t Sleep::workTime() const
+{
+    uint32_t total = SystemClock::instance().micros() - m_start;
+    return (total - m_sleepTime) / 1000;
+}
+
+void Sleep::resetStatistics()
+{
+    m_sleepTime = 0;
+    m_start = SystemClock::instance().micros();
+}
+
+}  // namespace Avr
@@ -0,0 +1,118 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#pragma once
+
+/*!
+ * \defgroup libtarget_sleep Sleep modes
+ * \ingroup libtarget
+ *
+ * \brief Avr::Sleep puts the CPU into idle sleep while waiting for
+ *        interrupts and accounts the time spent sleeping.
+ */
+
+/*!
+ * \file
+ * \ingroup libtarget_sleep
+ * \copydoc libtarget_sleep
+ */
+
+#include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
+
+namespace Avr
+{
+
+/*!
+ * \addtogroup libtarget_sleep
+ * \{
+ */
+
+/*!
+ * \brief Idle sleep with accounting of the time spent sleeping.
+ *
+ * In idle sleep mode, the CPU is halted while all peripherals (timers,
+ * input capture, UART, SPI, TWI, ADC) keep running and wake the CPU with
+ * their interrupts. The Avr::SystemClock tick wakes the CPU at least once
+ * per millisecond.
+ *
+ * Usage:
+ * \code
+ * while (true) {
+ *     if (!scheduler.runOnce())
+ *         Avr::Sleep::instance().idle();
+ * }
+ * \endcode
+ *
+ * \note The ADC noise reduction mode is not used because it halts the I/O
+ *       clock, which stops Timer0, the input capture of Timer1 and the UART.
+ */
+class Sleep
+{
+public:
+    /*!
+     * \brief Returns the Avr::Sleep instance.
+     *
+     * \return The Avr::Sleep instance.
+     */
+    static Sleep& instance()
+    {
+        return s_instance;
+    }
+
+    /*!
+     * \brief Sleeps until the next interrupt occurs.
+     *
+     * Returns immediately if interrupts are disabled as the CPU would never
+     * wake up again.
+     */
+    void idle();
+
+    /*!
+     * \brief Returns the time spent sleeping since the last reset.
+     *
+     * \return The time spent sleeping (in ms).
+     */
+    uint32_t sleepTime() const;
+
+    /*!
+     * \brief Returns the time spent working (not sleeping) since the last
+     *        reset.
+     *
+     * \return The time spent working (in ms).
+     */
+    uint32_t workTime() const;
+
+    /*!
+     * \brief Resets the sleep and work time.
+     */
+    void resetStatistics();
+
+private:
+    static Sleep s_instance;
+
+    // Both in us, the measurement period must not exceed 71 minutes
+    uint32_t m_sleepTime = 0;
+    uint32_t m_start = 0;
+
+    Sleep() = default;
+};
+
+/*! \} */  // \addtogroup libtarget_sleep
+
+}  // namespace Avr
@@ -0,0 +1,70 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "systemclock.h"
+
+#include <avr/interrupt.h>
+
+#include "lib/utils.h"
+
+#include "atomic.h"
+
+namespace Avr
+{
+
+SystemClock SystemClock::s_instance;
+
+SystemClock::SystemClock()
+{
+    // CTC mode, one compare match per millisecond
+    TCCR0A = (1 << WGM01);
+    OCR0A = c_compare;
+    TCNT0 = 0;
+    Sensors::bitSet(TIMSK0, OCIE0A);
+    TCCR0B = c_clockSelect;
+}
+
+uint32_t SystemClock::millis() const
+{
+    AtomicGuard<AtomicRestoreState> atomicGuard;
+    return m_millis;
+}
+
+uint32_t SystemClock::micros() const
+{
+    uint32_t millis;
+    uint8_t ticks;
+    {
+        AtomicGuard<AtomicRestoreState> atomicGuard;
+        millis = m_millis;
+        ticks = TCNT0;
+
+        // The counter has been cleared but the interrupt is still pending
+        if (Sensors::bitRead(TIFR0, OCF0A) && ticks < c_compare)
+            ++millis;
+    }
+    return millis * 1000 + ((uint32_t)ticks * c_tickScaled >> 8);
+}
+
+void SystemClock::CompareMatchInterrupt()
+{
+    ++s_instance.m_millis;
+}
+
+}  // namespace Avr
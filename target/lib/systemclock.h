@@ -0,0 +1,121 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#pragma once
+
+/*!
+ * \defgroup libtarget_systemclock System clock
+ * \ingroup libtarget
+ *
+ * \brief Avr::SystemClock provides a millisecond time base driven by
+ *        Timer0.
+ */
+
+/*!
+ * \file
+ * \ingroup libtarget_systemclock
+ * \copydoc libtarget_systemclock
+ */
+
+#include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
+
+#include <avr/io.h>
+
+#include "interrupt.h"
+
+#ifndef F_CPU
+#error "F_CPU not defined for systemclock.h"
+#endif
+
+namespace Avr
+{
+
+/*!
+ * \addtogroup libtarget_systemclock
+ * \{
+ */
+
+/*!
+ * \brief Millisecond time base using the Timer0 compare match interrupt.
+ *
+ * Timer0 is operated in CTC mode with a prescaler of 64 and generates one
+ * interrupt per millisecond. Sub-millisecond resolution is derived from the
+ * timer counter.
+ *
+ * Usage:
+ * \code
+ * uint32_t start = Avr::SystemClock::instance().micros();
+ * // ...
+ * uint32_t duration = Avr::SystemClock::instance().micros() - start;
+ * \endcode
+ *
+ * \note The time values wrap around after about 49 days (millis()) and
+ *       71 minutes (micros()). Use unsigned differences for comparisons.
+ */
+class SystemClock
+{
+public:
+    /*!
+     * \brief Returns the Avr::SystemClock instance.
+     *
+     * \return The Avr::SystemClock instance.
+     */
+    static SystemClock& instance()
+    {
+        return s_instance;
+    }
+
+    /*!
+     * \brief Returns the number of milliseconds since startup.
+     *
+     * \return The number of milliseconds since startup.
+     */
+    uint32_t millis() const;
+
+    /*!
+     * \brief Returns the number of microseconds since startup.
+     *
+     * The resolution is one Timer0 tick (4 us at 16 MHz).
+     *
+     * \return The number of microseconds since startup.
+     */
+    uint32_t micros() const;
+
+private:
+    CLASS_IRQ(CompareMatchInterrupt, TIMER0_COMPA_vect);
+
+    static SystemClock s_instance;
+
+    // Prescaler 64 (timer.h isn't included as it defines interrupt
+    // service routines)
+    static const uint8_t c_clockSelect = (1 << CS01) | (1 << CS00);
+    static const uint8_t c_compare = F_CPU / 64 / 1000 - 1;
+    static_assert(F_CPU / 64 / 1000 <= 256, "F_CPU too high for Timer0");
+
+    // Microseconds per Timer0 tick (in 1/256 us)
+    static const uint16_t c_tickScaled = (1000UL * 256) / (c_compare + 1);
+
+    volatile uint32_t m_millis = 0;
+
+    SystemClock();
+};
+
+/*! \} */  // \addtogroup libtarget_systemclock
+
+}  // namespace Avr
@@ -27,6 +27,7 @@
  *
  * - Common timer utilities: Avr::TimerUtils
  * - Input capture: Avr::TimerInputCapture
+ * - Deferred input capture processing: Avr::BufferedTimerObserver
  */
 
 /*!
@@ -41,8 +42,11 @@
 #include <avr/interrupt.h>
 
 #include "lib/utils.h"
+#include "lib/ringbuffer.h"
 
+#include "atomic.h"
 #include "interrupt.h"
+#include "trace.h"
 
 // Ensure compatibility with older ATmega processors
 #ifndef TIMSK1
@@ -124,6 +128,49 @@ struct TimerUtils
     }
 };
 
+/*!
+ * \brief Noise storm protection state of Avr::TimerInputCapture.
+ */
+enum class TimerStormState : uint8_t {
+    Normal,   //!< All pulses are forwarded
+    Filtered, //!< Noise canceler and glitch filter enabled
+    Masked    //!< Input capture interrupt disabled for a back-off period
+};
+
+/*!
+ * \brief Noise storm counters of Avr::TimerInputCapture.
+ *
+ * All counters saturate instead of wrapping around.
+ */
+struct TimerStormStatistics
+{
+    /*!
+     * \brief Number of detected noise storms (edge rate above threshold).
+     */
+    uint16_t storms = 0;
+
+    /*!
+     * \brief Number of times the input capture interrupt has been masked.
+     */
+    uint16_t backoffs = 0;
+
+    /*!
+     * \brief Number of pulses dropped by the glitch filter.
+     */
+    uint16_t glitches = 0;
+};
+
+/*!
+ * \brief Forwards a measured pulse width to the observer of
+ *        Avr::TimerInputCapture.
+ *
+ * Defined by the (single) instantiation of Avr::TimerInputCapture, so that
+ * the input capture interrupt calls the observer without virtual dispatch.
+ *
+ * \param pulseWidth The measured pulse width.
+ */
+void timerPulseWidthReceived(uint16_t pulseWidth);
+
 namespace internal
 {
 
@@ -135,24 +182,165 @@ namespace internal
  * Avr::TimerInputCapture needs to implement an interrupt service routine for
  * the input capture interrupt in order to be functional.
  *
+ * Timer1 runs freely. The capture unit latches the counter value into ICR1
+ * in hardware, so the measured pulse widths don't depend on the interrupt
+ * latency. The overflow interrupt extends the counter to 32 bit.
+ *
+ * The overflow interrupt also implements the noise storm protection. The
+ * number of edges is evaluated once per overflow period (65536 ticks):
+ * - Normal: If the edge rate exceeds the threshold, the noise canceler
+ *   (ICNC1) and the glitch filter are enabled (Filtered).
+ * - Filtered: If the edge rate stays above the threshold, the input capture
+ *   interrupt is masked for c_backoffPeriods overflow periods (Masked).
+ *   Below a quarter of the threshold, the filters are disabled (Normal).
+ * - Masked: After the back-off period, the input capture interrupt is
+ *   enabled again (Filtered).
+ *
  * \note This class cannot be used directly.
  */
 class TimerInputCaptureBase
 {
     CLASS_IRQ(InputCaptureInterrupt, TIMER1_CAPT_vect);
-    static TimerInputCaptureBase* s_baseInstance;
+    CLASS_IRQ(OverflowInterrupt, TIMER1_OVF_vect);
+
+public:
+    /*!
+     * \brief Returns the current 32 bit timer value.
+     *
+     * \return The current timer value (in ticks).
+     */
+    static uint32_t ticks()
+    {
+        AtomicGuard<AtomicRestoreState> atomicGuard;
+        return extend(TCNT1);
+    }
+
+    /*!
+     * \brief Returns the current state of the noise storm protection.
+     *
+     * \return The Avr::TimerStormState.
+     */
+    static TimerStormState stormState()
+    {
+        return s_stormState;
+    }
+
+    /*!
+     * \brief Returns the noise storm counters.
+     *
+     * \return The Avr::TimerStormStatistics.
+     */
+    static TimerStormStatistics stormStatistics()
+    {
+        AtomicGuard<AtomicRestoreState> atomicGuard;
+        return s_stormStatistics;
+    }
 
-    virtual void _pulseWidthReceived(uint16_t) = 0;
+protected:
+    /*!
+     * \brief Number of overflow periods the input capture interrupt stays
+     *        masked during a noise storm.
+     */
+    static const uint8_t c_backoffPeriods = 8;
+
+    static uint16_t s_maxEdges;
+    static uint16_t s_minPulseWidth;
+
+private:
+    static uint16_t s_overflows;
+    static uint32_t s_lastCapture;
+    static uint16_t s_edges;
+    static uint8_t s_backoff;
+    static TimerStormState s_stormState;
+    static TimerStormStatistics s_stormStatistics;
+
+    static void increment(uint16_t &counter)
+    {
+        if (counter != UINT16_MAX)
+            ++counter;
+    }
+
+    // Has to be called with interrupts disabled
+    static uint32_t extend(uint16_t ticks)
+    {
+        uint16_t overflows = s_overflows;
+
+        // The counter has wrapped but the interrupt is still pending
+        if (Sensors::bitRead(TIFR1, TOV1) && ticks < 0x8000)
+            ++overflows;
+        return (uint32_t)overflows << 16 | ticks;
+    }
 };
-TimerInputCaptureBase *TimerInputCaptureBase::s_baseInstance = nullptr;
+uint16_t TimerInputCaptureBase::s_maxEdges = UINT16_MAX;
+uint16_t TimerInputCaptureBase::s_minPulseWidth = 0;
+uint16_t TimerInputCaptureBase::s_overflows = 0;
+uint32_t TimerInputCaptureBase::s_lastCapture = 0;
+uint16_t TimerInputCaptureBase::s_edges = 0;
+uint8_t TimerInputCaptureBase::s_backoff = 0;
+TimerStormState TimerInputCaptureBase::s_stormState = TimerStormState::Normal;
+TimerStormStatistics TimerInputCaptureBase::s_stormStatistics;
 
 void TimerInputCaptureBase::InputCaptureInterrupt()
 {
-    s_baseInstance->_pulseWidthReceived(TCNT1);
-    TCNT1 = 0;
+    TRACE_SCOPE(Sensors::TraceEvent::InputCapture);
+    uint32_t capture = extend(ICR1);
 
-    // Flip edge detection
+    // Flip edge detection, this may set the capture flag again
     Sensors::bitFlip(TCCR1B, ICES1);
+    TIFR1 = (1 << ICF1);
+
+    if (s_edges != UINT16_MAX)
+        ++s_edges;
+
+    uint32_t pulseWidth = capture - s_lastCapture;
+    if (s_stormState != TimerStormState::Normal &&
+            pulseWidth < s_minPulseWidth) {
+        // Glitch: the next pulse width is measured from the last valid edge
+        increment(s_stormStatistics.glitches);
+        return;
+    }
+
+    s_lastCapture = capture;
+    timerPulseWidthReceived(pulseWidth > UINT16_MAX ? UINT16_MAX :
+                                                      pulseWidth);
+}
+
+void TimerInputCaptureBase::OverflowInterrupt()
+{
+    TRACE_SCOPE(Sensors::TraceEvent::TimerOverflow);
+    ++s_overflows;
+
+    uint16_t edges = s_edges;
+    s_edges = 0;
+
+    switch (s_stormState) {
+    case TimerStormState::Normal:
+        if (edges > s_maxEdges) {
+            Sensors::bitSet(TCCR1B, ICNC1);
+            s_stormState = TimerStormState::Filtered;
+            increment(s_stormStatistics.storms);
+        }
+        break;
+    case TimerStormState::Filtered:
+        if (edges > s_maxEdges) {
+            Sensors::bitClear(TIMSK1, TICIE1);
+            s_backoff = c_backoffPeriods;
+            s_stormState = TimerStormState::Masked;
+            increment(s_stormStatistics.backoffs);
+        } else if (edges <= s_maxEdges / 4) {
+            Sensors::bitClear(TCCR1B, ICNC1);
+            s_stormState = TimerStormState::Normal;
+        }
+        break;
+    case TimerStormState::Masked:
+        if (--s_backoff == 0) {
+            // Discard the edge captured while masked
+            TIFR1 = (1 << ICF1);
+            Sensors::bitSet(TIMSK1, TICIE1);
+            s_stormState = TimerStormState::Filtered;
+        }
+        break;
+    }
 }
 
 }  // namespace internal
@@ -161,6 +349,15 @@ void TimerInputCaptureBase::InputCaptureInterrupt()
  * \brief C++ wrapper for accessing the built-in input capture facility for
  *        measuring the width of external pulses.
  *
+ * Pulse widths are measured as difference between the hardware latched
+ * capture values of the free running Timer1. Pulses longer than the 16 bit
+ * range are reported as `UINT16_MAX`.
+ *
+ * If the edge rate exceeds \p maxEdgeRate (e.g. because of a nearby noise
+ * source), pulses shorter than \p minPulseWidth are dropped and the input
+ * capture interrupt is temporarily masked if the storm continues (see
+ * internal::TimerInputCaptureBase and stormStatistics()).
+ *
  * Usage:
  * \code
  * struct MyTimerObserver {
@@ -180,10 +377,18 @@ void TimerInputCaptureBase::InputCaptureInterrupt()
  * \tparam prescaler The prescaler for the timer configuration.
  * \tparam TObserver The observer that is notified of input capture events
  *         using its `void pulseWidthReceived(uint16_t pulseWidth)` function.
+ *         The function is called statically from the interrupt.
+ * \tparam maxEdgeRate Edge rate (in edges per second) above which the noise
+ *         storm protection kicks in.
+ * \tparam minPulseWidth Pulses shorter than this (in us) are dropped while
+ *         the noise storm protection is active.
+ *
+ * \note Only one Avr::TimerInputCapture can be instantiated.
  */
-template <uint16_t prescaler, class TObserver>
+template <uint16_t prescaler, class TObserver, uint16_t maxEdgeRate = 8000,
+          uint16_t minPulseWidth = 100>
 class TimerInputCapture
-        : private internal::TimerInputCaptureBase, private TObserver
+        : public internal::TimerInputCaptureBase, private TObserver
 {
 public:
     /*!
@@ -201,26 +406,129 @@ private:
 
     TimerInputCapture()
     {
+        // Normal mode (free running)
+        TCCR1A = 0;
         TCCR1B |= TimerUtils<prescaler>::clockSelect();
 
         // Input capture edge select: start with rising edge
         Sensors::bitSet(TCCR1B, ICES1);
 
-        // Enable input capture
+        // Enable input capture and overflow interrupts
         Sensors::bitSet(TIMSK1, TICIE1);
+        Sensors::bitSet(TIMSK1, TOIE1);
 
-        s_baseInstance = this;
+        s_maxEdges = c_maxEdges;
+        s_minPulseWidth = TimerUtils<prescaler>::template
+                usToTicks<minPulseWidth>();
     }
 
-    void _pulseWidthReceived(uint16_t pulseWidth)
+    // Edges per overflow period (65536 ticks)
+    static constexpr uint16_t c_maxEdges =
+        ((uint64_t)maxEdgeRate * 65536 * prescaler) / F_CPU;
+
+    friend void timerPulseWidthReceived(uint16_t pulseWidth)
     {
-        s_instance.pulseWidthReceived(pulseWidth);
+        TObserver::pulseWidthReceived(pulseWidth);
     }
 };
 
-template <uint16_t prescaler, class TObserver>
-TimerInputCapture<prescaler, TObserver>
-TimerInputCapture<prescaler, TObserver>::s_instance = TimerInputCapture();
+template <uint16_t prescaler, class TObserver, uint16_t maxEdgeRate,
+          uint16_t minPulseWidth>
+TimerInputCapture<prescaler, TObserver, maxEdgeRate, minPulseWidth>
+TimerInputCapture<prescaler, TObserver, maxEdgeRate, minPulseWidth>::
+s_instance = TimerInputCapture();
+
+/*!
+ * \brief Observer for Avr::TimerInputCapture that defers the processing of
+ *        pulse widths from the input capture interrupt to the main loop.
+ *
+ * Within the interrupt service routine, the measured pulse width is only
+ * pushed into a lock-free ring buffer. The main loop has to call process()
+ * regularly which forwards the buffered pulse widths to \p TObserver.
+ * This keeps the interrupt service routine short, even if \p TObserver
+ * executes expensive decoding algorithms.
+ *
+ * Usage:
+ * \code
+ * struct MyTimerObserver {
+ *     static void pulseWidthReceived(uint16_t pulseWidth) {
+ *         // Called from the main loop by process()
+ *     }
+ * };
+ * using MyBufferedObserver = Avr::BufferedTimerObserver<MyTimerObserver, 64>;
+ *
+ * int main() {
+ *     // ...
+ *     Avr::TimerInputCapture<8, MyBufferedObserver>::instance();
+ *     sei();
+ *     while (true) {
+ *         MyBufferedObserver::process();
+ *         // ...
+ *     }
+ * }
+ * \endcode
+ *
+ * \tparam TObserver The observer that is notified of input capture events
+ *         using its `void pulseWidthReceived(uint16_t pulseWidth)` function.
+ * \tparam TSize Number of pulse widths that can be buffered (power of two,
+ *         max 128). Pulse widths received while the buffer is full are
+ *         dropped and counted (see overflows()).
+ */
+template <class TObserver, uint8_t TSize>
+class BufferedTimerObserver : private TObserver
+{
+public:
+    /*!
+     * \brief Forwards buffered pulse widths to \p TObserver.
+     *
+     * Has to be called from the main loop (not from an interrupt service
+     * routine).
+     *
+     * \param maxPulseWidths Maximum number of pulse widths processed within
+     *        one call. Limits the time spent in this function.
+     * \return The number of processed pulse widths.
+     */
+    static uint8_t process(uint8_t maxPulseWidths = TSize)
+    {
+        uint8_t count = 0;
+        uint16_t pulseWidth;
+        while (count < maxPulseWidths && s_buffer.pop(pulseWidth)) {
+            TObserver::pulseWidthReceived(pulseWidth);
+            ++count;
+        }
+        return count;
+    }
+
+    /*!
+     * \brief Returns the number of pulse widths that have been dropped
+     *        because the buffer was full.
+     *
+     * \return The number of dropped pulse widths.
+     */
+    static uint16_t overflows()
+    {
+        return s_buffer.overflows();
+    }
+
+protected:
+    /*!
+     * \brief Called by Avr::TimerInputCapture from the input capture
+     *        interrupt.
+     *
+     * \param pulseWidth The measured pulse width.
+     */
+    static void pulseWidthReceived(uint16_t pulseWidth)
+    {
+        s_buffer.push(pulseWidth);
+    }
+
+private:
+    static Sensors::RingBuffer<uint16_t, TSize> s_buffer;
+};
+
+template <class TObserver, uint8_t TSize>
+Sensors::RingBuffer<uint16_t, TSize>
+BufferedTimerObserver<TObserver, TSize>::s_buffer;
 
 /*! \} */  // \addtogroup libtarget_timer
 
@@ -0,0 +1,182 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#pragma once
+
+/*!
+ * \defgroup libtarget_trace Tracing
+ * \ingroup libtarget
+ *
+ * \brief Trace points recording timestamped events into a RAM buffer.
+ */
+
+/*!
+ * \file
+ * \ingroup libtarget_trace
+ * \copydoc libtarget_trace
+ */
+
+#include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "lib/trace.h"
+
+namespace Avr
+{
+
+/*!
+ * \addtogroup libtarget_trace
+ * \{
+ */
+
+/*!
+ * \brief Records timestamped events into a RAM buffer.
+ *
+ * The timestamps are Timer1 values, Timer1 has to run freely (see
+ * Avr::TimerInputCapture). Use the TRACE_BEGIN, TRACE_END and TRACE_SCOPE
+ * macros instead of calling record() directly, they compile to nothing
+ * without the `TRACE` build option.
+ *
+ * Usage:
+ * \code
+ * void sendMessage() {
+ *     TRACE_SCOPE(Sensors::TraceEvent::Uart);
+ *     // ...
+ * }
+ *
+ * // Later
+ * auto trace = Avr::Trace::take();
+ * for (uint8_t i = 0; i < trace.size(); ++i) { ... }
+ * \endcode
+ */
+class Trace
+{
+public:
+    /*!
+     * \brief Number of records kept in the buffer (3 bytes each).
+     */
+    static const uint8_t c_bufferSize = 64;
+
+    /*!
+     * \brief The trace buffer type.
+     */
+    using Buffer = Sensors::TraceBuffer<c_bufferSize>;
+
+    /*!
+     * \brief Records \p event with the current Timer1 value.
+     *
+     * \param event The event id (optionally with Sensors::c_traceEnd).
+     */
+    static void record(uint8_t event)
+    {
+        uint8_t sreg = SREG;
+        cli();
+        s_buffer.add(event, TCNT1);
+        SREG = sreg;
+    }
+
+    /*!
+     * \brief Copies and clears the trace buffer.
+     *
+     * \return The recorded trace.
+     */
+    static Buffer take()
+    {
+        uint8_t sreg = SREG;
+        cli();
+        Buffer buffer = s_buffer;
+        s_buffer.clear();
+        SREG = sreg;
+        return buffer;
+    }
+
+private:
+    static Buffer s_buffer;
+};
+
+/*!
+ * \brief Records the begin of a section on construction and its end on
+ *        destruction.
+ */
+class TraceScope
+{
+public:
+    /*!
+     * \brief Records the begin of the section \p event.
+     *
+     * \param event The event id.
+     */
+    explicit TraceScope(uint8_t event)
+        : m_event(event)
+    {
+        Trace::record(m_event);
+    }
+
+    ~TraceScope()
+    {
+        Trace::record(m_event | Sensors::c_traceEnd);
+    }
+
+private:
+    uint8_t m_event;
+};
+
+/*! \} */  // \addtogroup libtarget_trace
+
+}  // namespace Avr
+
+#ifdef TRACE
+/*!
+ * \brief Records the begin of the section \p event (Sensors::TraceEvent or
+ *        event id).
+ *
+ * Compiles to nothing without the `TRACE` build option.
+ *
+ * \hideinitializer
+ */
+#define TRACE_BEGIN(event) \
+    ::Avr::Trace::record(static_cast<uint8_t>(event))
+
+/*!
+ * \brief Records the end of the section \p event.
+ *
+ * Compiles to nothing without the `TRACE` build option.
+ *
+ * \hideinitializer
+ */
+#define TRACE_END(event) \
+    ::Avr::Trace::record(static_cast<uint8_t>(event) | \
+                         ::Sensors::c_traceEnd)
+
+/*!
+ * \brief Records the section \p event until the end of the current scope.
+ *
+ * Compiles to nothing without the `TRACE` build option.
+ *
+ * \hideinitializer
+ */
+#define TRACE_SCOPE(event) \
+    ::Avr::TraceScope _traceScope(static_cast<uint8_t>(event))
+#else
+#define TRACE_BEGIN(event) do {} while (0)
+#define TRACE_END(event) do {} while (0)
+#define TRACE_SCOPE(event) do {} while (0)
+#endif
@@ -0,0 +1,137 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "twi.h"
+
+#include <avr/interrupt.h>
+#include <util/twi.h>
+
+#include "atomic.h"
+#include "trace.h"
+
+namespace Avr
+{
+
+Twi Twi::s_instance;
+
+Twi::Twi()
+{
+    TWSR = 0;  // Prescaler 1
+    TWBR = ((F_CPU / c_sclClock) - 16) / 2;
+}
+
+bool Twi::submit(TwiTransaction &transaction)
+{
+    AtomicGuard<AtomicRestoreState> atomicGuard;
+    if (transaction.isPending() || !m_queue.push(&transaction))
+        return false;
+
+    transaction.m_status = TwiStatus::Pending;
+    if (!m_current) {
+        while (TWCR & (1 << TWSTO)) {}  // Previous stop condition
+        startNext(false);
+    }
+    return true;
+}
+
+void Twi::TwiInterrupt()
+{
+    TRACE_SCOPE(Sensors::TraceEvent::Twi);
+    s_instance.handleInterrupt();
+}
+
+void Twi::handleInterrupt()
+{
+    TwiTransaction *transaction = m_current;
+    uint8_t control = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+
+    switch (TW_STATUS) {
+    case TW_START:
+    case TW_REP_START:
+        m_index = 0;
+        TWDR = (transaction->m_address << 1) |
+                (m_reading ? TW_READ : TW_WRITE);
+        break;
+
+    case TW_MT_SLA_ACK:
+    case TW_MT_DATA_ACK:
+        if (m_index < transaction->m_writeLength) {
+            TWDR = transaction->m_writeData[m_index++];
+        } else if (transaction->m_readLength > 0) {
+            m_reading = true;
+            control |= (1 << TWSTA);  // Repeated start
+        } else {
+            finish(TwiStatus::Complete);
+            return;
+        }
+        break;
+
+    case TW_MR_DATA_ACK:
+        transaction->m_readData[m_index++] = TWDR;
+        // fall through
+    case TW_MR_SLA_ACK:
+        // Acknowledge all but the last byte
+        if (m_index + 1 < transaction->m_readLength)
+            control |= (1 << TWEA);
+        break;
+
+    case TW_MR_DATA_NACK:
+        transaction->m_readData[m_index++] = TWDR;
+        finish(TwiStatus::Complete);
+        return;
+
+    default:  // Not acknowledged, arbitration lost or bus error
+        finish(TwiStatus::Error);
+        return;
+    }
+
+    TWCR = control;
+}
+
+void Twi::finish(TwiStatus status)
+{
+    TwiTransaction *transaction = m_current;
+    transaction->m_status = status;
+    if (transaction->m_callback)
+        transaction->m_callback(*transaction);
+
+    startNext(true);
+}
+
+void Twi::startNext(bool stop)
+{
+    uint8_t control = (1 << TWINT) | (1 << TWEN);
+    if (stop)
+        control |= (1 << TWSTO);
+
+    TwiTransaction *transaction = nullptr;
+    if (m_queue.pop(transaction)) {
+        // A start condition is sent after the stop condition
+        m_index = 0;
+        m_reading = transaction->m_writeLength == 0 &&
+                transaction->m_readLength > 0;
+        control |= (1 << TWSTA) | (1 << TWIE);
+    }
+    m_current = transaction;
+
+    if (stop || transaction)
+        TWCR = control;
+}
+
+}  // namespace Avr
@@ -0,0 +1,245 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#pragma once
+
+/*!
+ * \defgroup libtarget_twi Asynchronous I2C (TWI) module
+ * \ingroup libtarget
+ *
+ * \brief Interrupt driven I2C (TWI) master for non-blocking transactions.
+ *
+ * In contrast to Avr::I2c, which waits for the completion of every single
+ * byte, Avr::Twi processes queued transactions in the TWI interrupt service
+ * routine. The main loop only submits transactions and checks for their
+ * completion, so the CPU stays available while the bus is busy.
+ */
+
+/*!
+ * \file
+ * \ingroup libtarget_twi
+ * \copydoc libtarget_twi
+ */
+
+#include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
+
+#include <avr/io.h>
+
+#include "lib/ringbuffer.h"
+
+#include "interrupt.h"
+
+#ifndef F_CPU
+#error "F_CPU not defined for twi.h"
+#endif
+
+namespace Avr
+{
+
+class Twi;
+
+/*!
+ * \addtogroup libtarget_twi
+ * \{
+ */
+
+/*!
+ * \brief Status of an Avr::TwiTransaction.
+ */
+enum class TwiStatus : uint8_t {
+    /*!
+     * The transaction has not been submitted yet.
+     */
+    Idle = 0,
+
+    /*!
+     * The transaction is queued or being processed.
+     */
+    Pending,
+
+    /*!
+     * The transaction has been completed successfully.
+     */
+    Complete,
+
+    /*!
+     * The slave device didn't acknowledge or the bus was lost.
+     */
+    Error
+};
+
+/*!
+ * \brief A single I2C (TWI) transaction processed by Avr::Twi.
+ *
+ * A transaction consists of an optional write phase followed by an optional
+ * read phase. If both phases are present, they are connected by a repeated
+ * start condition. This covers the typical register access of I2C sensors:
+ * writing the register address and reading back its content.
+ *
+ * The transaction object and the buffers must stay valid until the
+ * transaction is completed.
+ */
+class TwiTransaction
+{
+public:
+    /*!
+     * \brief Function called from the interrupt service routine when the
+     *        transaction is completed (successfully or not).
+     */
+    using Callback = void (*)(TwiTransaction &transaction);
+
+    /*!
+     * \brief Configures the transaction.
+     *
+     * Must not be called while the transaction is pending.
+     *
+     * \param address The (7 bit) address of the slave device.
+     * \param writeData The bytes to transmit.
+     * \param writeLength The number of bytes to transmit.
+     * \param readData Memory location the received bytes are stored into.
+     * \param readLength The number of bytes to receive.
+     * \param callback Optional function that is called on completion.
+     */
+    void setup(uint8_t address, const uint8_t *writeData,
+               uint8_t writeLength, uint8_t *readData = nullptr,
+               uint8_t readLength = 0, Callback callback = nullptr)
+    {
+        m_address = address;
+        m_writeData = writeData;
+        m_writeLength = writeLength;
+        m_readData = readData;
+        m_readLength = readLength;
+        m_callback = callback;
+    }
+
+    /*!
+     * \brief Returns the status of the transaction.
+     *
+     * \return The status of the transaction.
+     */
+    TwiStatus status() const
+    {
+        return m_status;
+    }
+
+    /*!
+     * \brief Determines if the transaction is queued or being processed.
+     *
+     * \return `true` if the transaction is pending, `false` otherwise.
+     */
+    bool isPending() const
+    {
+        return m_status == TwiStatus::Pending;
+    }
+
+private:
+    friend class Twi;
+
+    uint8_t m_address = 0;
+    const uint8_t *m_writeData = nullptr;
+    uint8_t m_writeLength = 0;
+    uint8_t *m_readData = nullptr;
+    uint8_t m_readLength = 0;
+    Callback m_callback = nullptr;
+    volatile TwiStatus m_status = TwiStatus::Idle;
+};
+
+/*!
+ * \brief Interrupt driven I2C (TWI) master.
+ *
+ * Usage:
+ * \code
+ * static uint8_t reg = 0x06;
+ * static uint8_t data[3];
+ * static Avr::TwiTransaction transaction;
+ *
+ * transaction.setup(0x5A, &reg, 1, data, sizeof(data));
+ * Avr::Twi::instance().submit(transaction);
+ * while (transaction.isPending()) {
+ *     // Do something else
+ * }
+ * if (transaction.status() == Avr::TwiStatus::Complete) {
+ *     // Use data
+ * }
+ * \endcode
+ *
+ * Transactions are processed in the order they have been submitted. The
+ * completion is signaled by the status of the transaction and optionally by
+ * a callback.
+ *
+ * \note Avr::Twi is limited to I2C (TWI) master functionality and must not be
+ *       used concurrently with Avr::I2c.
+ */
+class Twi
+{
+public:
+    /*!
+     * \brief Returns the Avr::Twi instance.
+     *
+     * \return The Avr::Twi instance.
+     */
+    static Twi& instance()
+    {
+        return s_instance;
+    }
+
+    /*!
+     * \brief Queues the \p transaction for processing.
+     *
+     * If the bus is idle, the transaction is started immediately.
+     *
+     * \param transaction The transaction to process.
+     * \return `true` if the transaction has been queued, `false` if it is
+     *         already pending or the queue is full.
+     */
+    bool submit(TwiTransaction &transaction);
+
+    /*!
+     * \brief Determines if a transaction is being processed.
+     *
+     * \return `true` if the bus is busy, `false` otherwise.
+     */
+    bool isBusy() const
+    {
+        return m_current != nullptr;
+    }
+
+private:
+    CLASS_IRQ(TwiInterrupt, TWI_vect);
+
+    static Twi s_instance;
+
+    static const uint32_t c_sclClock = 100000;  // 100 kHz
+    static const uint8_t c_queueSize = 4;
+
+    Sensors::RingBuffer<TwiTransaction *, c_queueSize> m_queue;
+    TwiTransaction *volatile m_current = nullptr;
+    uint8_t m_index = 0;
+    bool m_reading = false;
+
+    Twi();
+
+    void handleInterrupt();
+    void finish(TwiStatus status);
+    void startNext(bool stop);
+};
+
+/*! \} */  // \addtogroup libtarget_twi
+
+}  // namespace Avr
@@ -37,6 +37,8 @@
 
 #include <stdlib.h>
 
+#include "lib/flashstring.h"
+
 extern "C" {
     #include <external/uart/uart.h>
 }
@@ -57,6 +59,7 @@ namespace Avr
  * \code
  * auto uart = Avr::Uart<9600>::instance();
  * uart.sendString("Hello UART!");
+ * uart.sendLine(FLASH_STRING("Hello from flash!"));
  * \endcode
  *
  * This template must not be instantiated more than once.
@@ -108,6 +111,36 @@ public:
         }
     }
 
+    /*!
+     * \brief Transmits the null-terminated string \p str from program
+     *        memory.
+     *
+     * The string is read character by character, it is not copied into
+     * SRAM.
+     *
+     * \param str The string to be sent.
+     */
+    void sendString(Sensors::FlashString str)
+    {
+        for (uint16_t i = 0; str[i] != '\0'; ++i) {
+            sendChar(str[i]);
+        }
+    }
+
+    /*!
+     * \brief Returns the next received character if available.
+     *
+     * \param c Memory location the received character is stored into.
+     * \return `true` if a character has been received, `false` otherwise.
+     */
+    bool receiveChar(unsigned char &c)
+    {
+        if (!uart0_available())
+            return false;
+        c = uart0_getc();
+        return true;
+    }
+
     /*!
      * \brief Transmits the null-terminated string \p str followed by a new
      *        line character.
@@ -120,6 +153,18 @@ public:
         sendChar('\n');
     }
 
+    /*!
+     * \brief Transmits the string \p str from program memory followed by a
+     *        new line character.
+     *
+     * \param str The line to be sent.
+     */
+    void sendLine(Sensors::FlashString str)
+    {
+        sendString(str);
+        sendChar('\n');
+    }
+
     /*!
      * \brief Transmits the string representation of the unsigned integer
      *        \p value.
@@ -149,7 +194,26 @@ public:
     void sendValue(const char *description, uint32_t value, uint8_t radix = 10)
     {
         sendString(description);
-        sendString(": ");
+        sendString(FLASH_STRING(": "));
+        sendUInt(value, radix);
+        sendChar('\n');
+    }
+
+    /*!
+     * \brief Transmits the string representation of the unsigned integer
+     *        \p value and its \p description from program memory.
+     *
+     * \param description A string in program memory describing the \p value.
+     * \param value The unsigned integer value to be sent.
+     * \param radix The radix for the number conversion.
+     *
+     * \sa sendValue(const char *, uint32_t, uint8_t)
+     */
+    void sendValue(Sensors::FlashString description, uint32_t value,
+                   uint8_t radix = 10)
+    {
+        sendString(description);
+        sendString(FLASH_STRING(": "));
         sendUInt(value, radix);
         sendChar('\n');
     }
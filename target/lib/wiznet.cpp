@@ -31,15 +31,103 @@ namespace Avr
 bool Wiznet::internalSendUdpMessage(
         IpAddress dest, uint16_t port, const char *message)
 {
-    int8_t so = socket(0, Sn_MR_UDP, 0, 0);
-    if (so < 0)
+    while (internalPollUdpStatus() == UdpStatus::Busy) {}
+
+    if (!internalQueueUdpMessage(dest, port, message))
+        return false;
+
+    UdpStatus status;
+    while ((status = internalPollUdpStatus()) == UdpStatus::Busy) {}
+    return status == UdpStatus::Sent;
+}
+
+bool Wiznet::internalQueueUdpMessage(
+        IpAddress dest, uint16_t port, const char *message)
+{
+    return internalAppendUdpData(reinterpret_cast<const uint8_t *>(message),
+                                 strlen(message)) &&
+           internalSendUdpData(dest, port);
+}
+
+bool Wiznet::internalAppendUdpData(const uint8_t *data, uint16_t length)
+{
+    if (!canAppendUdpData(length))
         return false;
 
-    int32_t status = sendto(so, reinterpret_cast<unsigned char*>(
-                            const_cast<char *>(message)), strlen(message),
-                            const_cast<uint8_t *>(dest.rawAddress()), port);
-    close(so);
-    return status > 0;
+    wiz_send_data(c_udpSocket, const_cast<uint8_t *>(data), length);
+    m_pendingLength += length;
+    return true;
+}
+
+bool Wiznet::internalAppendUdpData(Sensors::FlashString data)
+{
+    // Copied through a small stack buffer, wiz_send_data() reads from SRAM
+    static const uint8_t c_chunkSize = 16;
+    uint8_t chunk[c_chunkSize];
+
+    uint16_t length = data.length();
+    if (!canAppendUdpData(length))
+        return false;
+
+    for (uint16_t index = 0; index < length; index += c_chunkSize) {
+        uint16_t size = length - index;
+        if (size > c_chunkSize)
+            size = c_chunkSize;
+        data.copy(index, size, reinterpret_cast<char *>(chunk));
+        wiz_send_data(c_udpSocket, chunk, size);
+    }
+    m_pendingLength += length;
+    return true;
+}
+
+bool Wiznet::canAppendUdpData(uint16_t length)
+{
+    // Data must not be written while the module is transmitting
+    if (internalPollUdpStatus() == UdpStatus::Busy)
+        return false;
+
+    // Reopen the socket if it has been closed (e.g. after a chip reset)
+    if (getSn_SR(c_udpSocket) != SOCK_UDP && !openUdpSocket())
+        return false;
+
+    return length <= getSn_TX_FSR(c_udpSocket);
+}
+
+bool Wiznet::internalSendUdpData(IpAddress dest, uint16_t port)
+{
+    if (m_pendingLength == 0 || internalPollUdpStatus() == UdpStatus::Busy)
+        return false;
+
+    setSn_DIPR(c_udpSocket, const_cast<uint8_t *>(dest.rawAddress()));
+    setSn_DPORT(c_udpSocket, port);
+    setSn_CR(c_udpSocket, Sn_CR_SEND);
+    while (getSn_CR(c_udpSocket)) {}  // Command is accepted within cycles
+
+    m_pendingLength = 0;
+    m_status = UdpStatus::Busy;
+    return true;
+}
+
+UdpStatus Wiznet::internalPollUdpStatus()
+{
+    if (m_status == UdpStatus::Busy) {
+        uint8_t interrupts = getSn_IR(c_udpSocket);
+        if (interrupts & Sn_IR_SENDOK) {
+            setSn_IR(c_udpSocket, Sn_IR_SENDOK);
+            m_status = UdpStatus::Sent;
+        } else if (interrupts & Sn_IR_TIMEOUT) {
+            setSn_IR(c_udpSocket, Sn_IR_TIMEOUT);
+            m_status = UdpStatus::Timeout;
+        }
+    }
+    return m_status;
+}
+
+bool Wiznet::openUdpSocket()
+{
+    // Data appended to a previously opened socket is discarded
+    m_pendingLength = 0;
+    return socket(c_udpSocket, Sn_MR_UDP, 0, 0) == c_udpSocket;
 }
 
 Wiznet::Wiznet(
@@ -59,6 +147,13 @@ Wiznet::Wiznet(
     memcpy(config.sn, subnet.rawAddress(), 4);
     config.dhcp = NETINFO_STATIC;
     ctlnetwork(CN_SET_NETINFO, &config);
+
+    auto timeout = wiz_NetTimeout();
+    timeout.retry_cnt = c_retryCount;
+    timeout.time_100us = c_retryTime;
+    ctlnetwork(CN_SET_TIMEOUT, &timeout);
+
+    openUdpSocket();
 }
 
 }  // namespace Avr
@@ -21,6 +21,7 @@
 
 #include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
 
+#include "lib/flashstring.h"
 #include "lib/utils.h"
 
 #include "pin.h"
@@ -36,6 +37,12 @@ namespace Avr
  *
  * The usage is described in the documentation of the Avr::Ethernet module.
  *
+ * A single UDP socket is opened on initialization and kept open. Messages are
+ * copied into the module's transmit buffer (possibly in multiple parts) and
+ * sent without waiting for completion. The retry time and count for ARP
+ * requests are reduced so that an unreachable destination is detected within
+ * tens of milliseconds (instead of seconds with the defaults).
+ *
  * \note The implementation is based on the WIZnet ioLibrary
  *       (https://github.com/Wiznet/ioLibrary_Driver).
  */
@@ -46,8 +53,24 @@ protected:
 
     bool internalSendUdpMessage(IpAddress dest, uint16_t port,
                                 const char *message);
+    bool internalQueueUdpMessage(IpAddress dest, uint16_t port,
+                                 const char *message);
+    bool internalAppendUdpData(const uint8_t *data, uint16_t length);
+    bool internalAppendUdpData(Sensors::FlashString data);
+    bool internalSendUdpData(IpAddress dest, uint16_t port);
+    UdpStatus internalPollUdpStatus();
 
 private:
+    static const uint8_t c_udpSocket = 0;
+    static const uint16_t c_retryTime = 200;  // 20 ms (in 100 us units)
+    static const uint8_t c_retryCount = 2;
+
+    UdpStatus m_status = UdpStatus::Idle;
+    uint16_t m_pendingLength = 0;
+
+    bool openUdpSocket();
+    bool canAppendUdpData(uint16_t length);
+
     static void chipselect()
     {
         Spi<Avr::DigitalIoB, PB2>::instance().select();
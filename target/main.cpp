@@ -28,7 +28,9 @@
  * - Receives \a temperature and \a humidity from a Hideki Thermo/Hygro sensor
  *   connected to the AVR's input capture pin (ICP).
  * - Receives \a temperature and \a humidity from a DHT22 sensor connected to
- *   the AVR's digital I/O pin PD2.
+ *   the AVR's digital I/O pin PD2. With the `DHT22_CAPTURE` build option, the
+ *   sensor is read in the background using the pin change interrupt and
+ *   Timer2.
  * - Receives \a temperature and \a pressure from a Bosch BMP180 sensor
  *   connected to the AVR's I2C (TWI) interface.
  * - Receives \a ambient_temperature and \a object_temperature from a Melexis
@@ -36,8 +38,60 @@
  * - Receives \a sensor_resistance from a Figaro TGS 2600 sensor connected
  *   to the AVR's Analog to Digital Conversion pin 0 (ADC0).
  *
+ * Every sensor is read by its own task with an individual period using
+ * Avr::Scheduler. Sensors that are read in the background (I2C, DHT22 with
+ * `DHT22_CAPTURE`) are started by one task and transmitted by an event
+ * driven task as soon as the measurement is completed. The sensors with the
+ * same period are started one second apart so that their readings don't
+ * fill the output queues at once.
+ *
  * The received sensor values are transmitted over the UART interface and / or
- * over Ethernet using UDP messages as JSON object.
+ * over Ethernet using UDP messages as JSON object. Each JSON object is
+ * terminated by a new line. Objects are combined into UDP datagrams that are
+ * sent at least once per second.
+ *
+ * The outputs are selected with the `OUTPUT_UART` and `OUTPUT_UDP` build
+ * options. Each message is formatted on the stack and copied into the queue
+ * of every enabled output (see \ref libtarget_outputsink), so the next
+ * message is formatted while the previous ones are still being transmitted.
+ * The outputs are drained by separate tasks: the UART at the speed of the
+ * serial line, UDP whenever the previous datagram has been sent. A slow
+ * UART therefore doesn't delay UDP. If a queue is full, the UART drops the
+ * new message and UDP drops the oldest one.
+ *
+ * Readings of the Hideki sensors are transmitted every 30 s. With the
+ * `RF_FORWARD_IMMEDIATE` build option, every decoded reading is queued
+ * instead and transmitted by an event driven task as soon as the UDP batch
+ * accepts messages. The UDP datagram containing the reading is sent
+ * immediately. Readings are stamped when they are decoded, readings that
+ * leave the queue later than `RF_MAX_LATENCY` (in ms) are counted as `late`
+ * in the `rf_frames` object.
+ *
+ * The runtime statistics of all tasks are transmitted periodically as
+ * `task_<index>` objects. The CPU sleeps while no task is runnable. The
+ * time spent sleeping and working is reported as `cpu` object, the static
+ * RAM usage and the stack high-water mark as `memory` object (see
+ * Avr::Memory). The counters of the RF noise storm protection (see
+ * Avr::TimerInputCapture) are reported as `rf_receiver` object. With the
+ * `HEALTH_STATISTICS` build option, the counters of the RF decoder, the
+ * DHT22, the I2C bus and the UART and UDP outputs are reported as well
+ * (`rf_pulses`, `rf_frames`, `dht22_status`, `i2c`, `uart` and `udp`
+ * objects). The objects of the report are transmitted one at a time while
+ * the output queues are empty, so they never push sensor readings out.
+ *
+ * With the `RF_DECODER_COMPACT` build option, the state of the RF decoders
+ * is packed into bitfields (see Sensors::PackedRfDeviceState). This saves
+ * one byte per RF decoder at the cost of a few instructions per pulse.
+ *
+ * With the `TRACE` build option, interrupts, tasks, message formatting and
+ * transmission are traced (see \ref libtarget_trace). Sending `t` over the
+ * UART interface dumps the trace buffer, which can be analyzed with
+ * \ref tools_tracetool.
+ *
+ * With the `WIRE_FORMAT_BINARY` build option, each JSON object is replaced by
+ * a COBS framed binary message (see \ref libsensors_wireformat) containing a
+ * sequence number. This reduces the transmission time on the UART interface
+ * to about a third.
  *
  * JSON Schema:
  * \code
@@ -122,6 +176,89 @@
  *                     "minimum": 0
  *                 }
  *             }
+ *         },
+ *         "cpu": {
+ *             "type": "object",
+ *             "properties": {
+ *                 "sleep_ms": {
+ *                     "description": "Time spent sleeping since the last "
+ *                                    "report in ms.",
+ *                     "type": "integer"
+ *                 },
+ *                 "work_ms": {
+ *                     "description": "Time spent working since the last "
+ *                                    "report in ms.",
+ *                     "type": "integer"
+ *                 }
+ *             }
+ *         },
+ *         "memory": {
+ *             "type": "object",
+ *             "properties": {
+ *                 "static_bytes": {
+ *                     "description": "Size of all static variables in "
+ *                                    "bytes.",
+ *                     "type": "integer"
+ *                 },
+ *                 "stack_max_bytes": {
+ *                     "description": "Maximum stack usage since startup "
+ *                                    "in bytes.",
+ *                     "type": "integer"
+ *                 },
+ *                 "stack_unused_bytes": {
+ *                     "description": "Memory never used since startup "
+ *                                    "in bytes.",
+ *                     "type": "integer"
+ *                 }
+ *             }
+ *         },
+ *         "rf_receiver": {
+ *             "type": "object",
+ *             "properties": {
+ *                 "storms": {
+ *                     "description": "Number of detected noise storms.",
+ *                     "type": "integer"
+ *                 },
+ *                 "backoffs": {
+ *                     "description": "Number of times the receiver has "
+ *                                    "been ignored during a storm.",
+ *                     "type": "integer"
+ *                 },
+ *                 "glitches": {
+ *                     "description": "Number of filtered glitches.",
+ *                     "type": "integer"
+ *                 }
+ *             }
+ *         },
+ *         "^(rf_pulses|rf_frames|dht22_status|i2c|uart|udp)$": {
+ *             "description": "Decoder and health counters since the "
+ *                            "last report (HEALTH_STATISTICS build "
+ *                            "option).",
+ *             "type": "object",
+ *             "additionalProperties": {
+ *                 "type": "integer"
+ *             }
+ *         },
+ *         "^task_[0-9]+$": {
+ *             "type": "object",
+ *             "properties": {
+ *                 "runs": {
+ *                     "description": "Number of runs since the last report.",
+ *                     "type": "integer"
+ *                 },
+ *                 "runtime_avg_us": {
+ *                     "description": "Average runtime in us.",
+ *                     "type": "integer"
+ *                 },
+ *                 "runtime_max_us": {
+ *                     "description": "Maximum runtime in us.",
+ *                     "type": "integer"
+ *                 },
+ *                 "deadline_misses": {
+ *                     "description": "Number of runs started too late.",
+ *                     "type": "integer"
+ *                 }
+ *             }
  *         }
  *     }
  * }
@@ -129,7 +266,9 @@
  *
  * \sa Sensors::HidekiSensor
  * \sa Avr::Dht22
+ * \sa Avr::Dht22Capture
  * \sa Sensors::Tgs2600
+ * \sa Avr::Scheduler
  */
 
 /*!
@@ -139,7 +278,6 @@
  */
 
 #include <inttypes.h>  // AVR toolchain doesn't offer cinttypes header
-#include <stdio.h>
 
 #include <avr/io.h>
 #include <avr/interrupt.h>
@@ -148,7 +286,10 @@
 #include "git-version.h"
 
 #include "lib/hidekisensor.h"
+#include "lib/jsonwriter.h"
+#include "lib/wireformat.h"
 #include "lib/dht22.h"
+#include "lib/dht22capture.h"
 #include "lib/bmp180.h"
 #include "lib/mlx90614.h"
 #include "lib/tgs2600.h"
@@ -160,28 +301,140 @@
 #include "lib/timer.h"
 #include "lib/pin.h"
 #include "lib/atomic.h"
+#include "lib/ringbuffer.h"
+#include "lib/scheduler.h"
+#include "lib/sleep.h"
+#include "lib/memory.h"
+#include "lib/trace.h"
+#include "lib/outputsink.h"
 
 static const uint16_t BAUD = 9600;
 static const uint16_t PRESCALER = 8;
 static const uint32_t TGS2600_LOADRESISTOR = 10000;
-static const uint32_t ALTITUDE = 470;
-static const uint32_t DELAY = 30000;
+static const int16_t ALTITUDE = 470;
+static const uint16_t PULSE_PROCESSING_INTERVAL = 10;
+static const uint16_t RF_INTERVAL = 30000;
+// Readings forwarded later than this (in ms) after decoding are counted
+static const uint16_t RF_MAX_LATENCY = 20;
+static const uint16_t DHT22_INTERVAL = 30000;
+static const uint16_t BMP180_INTERVAL = 30000;
+static const uint16_t MLX90614_INTERVAL = 30000;
+static const uint16_t TGS2600_INTERVAL = 30000;
+// Offsets of the first runs, one second apart so that the sensors of the
+// 30 s cycle don't transmit at the same time. The DHT22 reading is the
+// reference for the TGS2600.
+static const uint16_t DHT22_OFFSET = 1000;
+static const uint16_t BMP180_OFFSET = 2000;
+static const uint16_t MLX90614_OFFSET = 3000;
+static const uint16_t TGS2600_OFFSET = 4000;
+static const uint16_t OUTPUT_DEADLINE = 100;
+static const uint16_t FLUSH_INTERVAL = 1000;
+static const uint16_t REPORT_INTERVAL = 60000;
+// In between the sensor readings of the 30 s cycle
+static const uint16_t REPORT_OFFSET = 15000;
+// Report messages yield to sensor readings
+static const uint16_t REPORT_DEADLINE = 1000;
+static const uint16_t TRACE_POLL_INTERVAL = 100;
+static const uint16_t UART_DRAIN_INTERVAL = 10;
+static const uint8_t TASKS = 15;
+static const uint8_t PULSE_BUFFER_SIZE = 64;
+static const uint8_t RF_QUEUE_SIZE = 8;
 static const uint16_t SEND_BUFFER_SIZE = 128;
+// Header (flags and sequence number), up to five records and the CRC
+static const uint8_t WIRE_FRAME_SIZE = 2 + 5 * 6 + 1;
+// Largest UART burst: three Hideki readings of up to 66 bytes
+// (sendHidekiData) or a report message of up to 109 bytes plus two
+// forwarded Hideki readings (one length byte per message each). The other
+// sensors are staggered by their offsets and the report is sent one message
+// at a time.
+static const uint16_t UART_QUEUE_SIZE = 256;
+// UDP only queues while the previous datagram is being sent, which takes a
+// few milliseconds. This holds the largest message, older messages are
+// dropped in favor of newer ones if more arrive meanwhile.
+static const uint16_t UDP_QUEUE_SIZE = 128;
 
 static const Avr::MacAddress ETHERNET_MAC(0x00, 0x16, 0x36, 0xDE, 0x58, 0xF6);
 static const Avr::IpAddress ETHERNET_IP(10, 0, 1, 254);
 static const Avr::IpAddress ETHERNET_SUBNET(255, 255, 0, 0);
 static const Avr::IpAddress UDP_SERVER(10, 0, 1, 10);
 static const uint16_t UDP_PORT = 8600;
+static const uint16_t UDP_BATCH_THRESHOLD = 512;
+
+using Ethernet = Avr::Ethernet<Avr::Wiznet>;
+using UdpBatch = Avr::UdpBatch<Ethernet, UDP_BATCH_THRESHOLD>;
+
+/*!
+ * \brief Health counters that are not kept by the drivers.
+ *
+ * Only maintained with the `HEALTH_STATISTICS` build option. All counters
+ * saturate instead of wrapping around.
+ */
+struct HealthCounters
+{
+    uint16_t rfDropped = 0;      //!< Decoded RF frames that were dropped
+    uint16_t rfLate = 0;         //!< RF frames queued beyond RF_MAX_LATENCY
+    uint16_t dht22Errors = 0;    //!< Invalid DHT22 measurements
+    uint16_t dht22Timeouts = 0;  //!< DHT22 measurements without response
+    uint16_t twiErrors = 0;      //!< Failed I2C (TWI) measurements
+};
+
+#ifdef HEALTH_STATISTICS
+static HealthCounters s_health;
+using RfStatistics = Sensors::RfDeviceStatistics;
+#else
+using RfStatistics = Sensors::NoRfDeviceStatistics;
+#endif
+
+/*!
+ * \brief Increments the health \p counter.
+ *
+ * Does nothing without the `HEALTH_STATISTICS` build option.
+ *
+ * \param counter The counter to increment.
+ */
+static void count(uint16_t HealthCounters::*counter)
+{
+#ifdef HEALTH_STATISTICS
+    uint16_t &value = s_health.*counter;
+    if (value != UINT16_MAX)
+        ++value;
+#else
+    (void)counter;
+#endif
+}
+
+#ifdef RF_DECODER_COMPACT
+using RfState = Sensors::PackedRfDeviceState;
+#else
+using RfState = Sensors::RfDeviceState;
+#endif
 
 static const uint8_t HIDEKISENSORS = 3;
 static Sensors::HidekiDevice<
     Avr::TimerUtils<PRESCALER>::usToTicks<183>(),  // Short min
     Avr::TimerUtils<PRESCALER>::usToTicks<726>(),  // Short max
     Avr::TimerUtils<PRESCALER>::usToTicks<726>(),  // Long min
-    Avr::TimerUtils<PRESCALER>::usToTicks<1464>()  // Long max
+    Avr::TimerUtils<PRESCALER>::usToTicks<1464>(), // Long max
+    RfStatistics,
+    RfState
     > s_hidekiDevice;
+/*!
+ * \brief Decoded Hideki reading waiting in the queue.
+ */
+struct HidekiReading
+{
+    Sensors::HidekiData data;
+    // Lower 16 bit of Avr::SystemClock::millis() when decoded, enough for
+    // latencies up to a minute
+    uint16_t decoded = 0;
+};
+
+// Filled by the RF decoder (possibly in the ISR), drained by a task
+static Sensors::RingBuffer<HidekiReading, RF_QUEUE_SIZE> s_hidekiQueue;
+#ifndef RF_FORWARD_IMMEDIATE
+// Latest reading per channel, only accessed from the main loop
 static Sensors::HidekiData s_hidekiData[HIDEKISENSORS];
+#endif
 
 class TimerObserver
 {
@@ -191,111 +444,1000 @@ protected:
         if (s_hidekiDevice.addPulseWidth(pulseWidth) ==
                 Sensors::RfDeviceStatus::Complete) {
             uint8_t channel = s_hidekiDevice.channel();
-            if (channel > 0 && channel <= HIDEKISENSORS) {
-                s_hidekiData[channel-1].storeSensorValues(s_hidekiDevice);
+            HidekiReading reading;
+            reading.data.storeSensorValues(s_hidekiDevice);
+            reading.decoded = Avr::SystemClock::instance().millis();
+            if (channel == 0 || channel > HIDEKISENSORS ||
+                    !s_hidekiQueue.push(reading)) {
+                count(&HealthCounters::rfDropped);
             }
         }
     }
 };
 
+#ifdef RF_CAPTURE_BUFFERED
+// Decode pulse widths in the main loop, the ISR only buffers them
+using CaptureObserver = Avr::BufferedTimerObserver<TimerObserver,
+                                                   PULSE_BUFFER_SIZE>;
+#else
+// Decode pulse widths directly in the ISR
+using CaptureObserver = TimerObserver;
+#endif
+using InputCapture = Avr::TimerInputCapture<PRESCALER, CaptureObserver>;
+
+#ifdef DHT22_CAPTURE
+static Avr::Dht22Capture<PD2> s_dht22;
+#else
+static Avr::Dht22<Avr::InputOutputPin<Avr::DigitalIoD, PD2>> s_dht22;
+#endif
+static Avr::Bmp180 s_bmp180(Avr::Bmp180::Mode::UltraHighResolution);
+static Avr::Mlx90614 s_mlx90614;
+static Sensors::Tgs2600<TGS2600_LOADRESISTOR> s_tgs2600;
+
+// Task indices are transmitted as channel (4 bit) in the binary wire format
+static_assert(TASKS <= 16, "Too many tasks");
+static Avr::Scheduler<TASKS> s_scheduler;
+
 /*!
- * \brief Application entry point.
+ * \brief Forwards buffered pulse widths to the RF decoders.
  *
- * \return As main application, this function does not return.
+ * Has to be called regularly from the main loop so that the pulse width
+ * buffer doesn't overflow. Without RF_CAPTURE_BUFFERED, pulse widths are
+ * decoded in the ISR and this function does nothing.
  */
-int main()
+static void processPulseWidths()
 {
-    Avr::TimerInputCapture<PRESCALER, TimerObserver>::instance();
+#ifdef RF_CAPTURE_BUFFERED
+    CaptureObserver::process();
+#endif
+}
 
-    sei();  // Enable interrupts
+/*!
+ * \brief Formats the values of a sensor as JSON line.
+ *
+ * Shares its interface with BinaryMessage, the sensor and quantity ids are
+ * ignored.
+ */
+class JsonMessage
+{
+public:
+    JsonMessage()
+        : m_sink(m_buffer, sizeof(m_buffer))
+        , m_json(m_sink)
+    {
+    }
 
-    Avr::Dht22<Avr::InputOutputPin<Avr::DigitalIoD, PD2>> dht22;
-    Avr::Bmp180 bmp180(Avr::Bmp180::Mode::UltraHighResolution);
-    Avr::Mlx90614 mlx90614;
+    void begin(Sensors::FlashString name, Sensors::WireSensor)
+    {
+        TRACE_BEGIN(Sensors::TraceEvent::Format);
+        m_json.beginObject();
+        m_json.beginObject(name);
+    }
 
-    Sensors::Tgs2600<TGS2600_LOADRESISTOR> tgs2600;
+    void begin(Sensors::FlashString prefix, Sensors::WireSensor,
+               uint8_t channel)
+    {
+        TRACE_BEGIN(Sensors::TraceEvent::Format);
+        m_json.beginObject();
+        m_json.beginObject(prefix, channel);
+    }
 
-    // Arduino boards restart when a serial connection is established (DTR).
-    // Transmitting an initial string allows the client to know that the
-    // microcontroller is ready.
-    auto uart = Avr::Uart<BAUD>::instance();
-    uart.sendLine("VERSION: " GIT_VERSION);
-    uart.sendLine("READY");
+    template <uint8_t TDigits>
+    void addValue(Sensors::FlashString key, Sensors::WireQuantity,
+                  Sensors::FixedPoint<TDigits> value)
+    {
+        m_json.addValue(key, value);
+    }
 
-    auto ethernet = Avr::Ethernet<Avr::Wiznet>(ETHERNET_MAC,
-                                               ETHERNET_IP, ETHERNET_SUBNET);
-    uart.sendLine("ETHERNET READY");
+    void addUInt(Sensors::FlashString key, Sensors::WireQuantity,
+                 uint32_t value)
+    {
+        m_json.addUInt(key, value);
+    }
 
-    char str[SEND_BUFFER_SIZE];
+    void addBool(Sensors::FlashString key, Sensors::WireQuantity, bool value)
+    {
+        m_json.addBool(key, value);
+    }
 
-    while (true) {
-        // Copy Hideki sensor result set
-        Sensors::HidekiData hidekiData[HIDEKISENSORS];
-        {
-            Avr::AtomicGuard<Avr::AtomicRestoreState> atomicGuard;
-            for (int channel = 0; channel < HIDEKISENSORS; ++channel) {
-                if (s_hidekiData[channel].isValid()) {
-                    hidekiData[channel] = s_hidekiData[channel];
-                    s_hidekiData[channel].reset();
-                }
-            }
-        }
+    void end()
+    {
+        m_json.endObject();
+        m_json.endObject();
+        m_sink.write('\n');
+        TRACE_END(Sensors::TraceEvent::Format);
+    }
 
-        for (const auto &sensor : hidekiData) {
-            if (sensor.isValid()) {
-                snprintf(str, SEND_BUFFER_SIZE,
-                    "{\"rf433_%d\":{\"temperature\":%.2f,\"humidity\":%d,"
-                                   "\"battery\":%s}}\n",
-                    sensor.channel(),
-                    static_cast<double>(sensor.temperatureF()),
-                    sensor.humidity(),
-                    sensor.batteryOk() ? "true" : "false");
-                uart.sendString(str);
-                ethernet.sendUdpMessage(UDP_SERVER, UDP_PORT, str);
-            }
-        }
+    const uint8_t *data() const
+    {
+        return reinterpret_cast<const uint8_t *>(m_buffer);
+    }
 
-        if (dht22.read()) {
-            snprintf(str, SEND_BUFFER_SIZE,
-                     "{\"dht22\":{\"temperature\":%.2f,\"humidity\":%.2f}}\n",
-                     static_cast<double>(dht22.temperature()),
-                     static_cast<double>(dht22.humidity()));
-            uart.sendString(str);
-            ethernet.sendUdpMessage(UDP_SERVER, UDP_PORT, str);
+    uint16_t length() const
+    {
+        return m_sink.length();
+    }
 
-            tgs2600.setReferenceTemperature(dht22.temperature());
-            tgs2600.setReferenceHumidity(dht22.humidity());
-        }
+private:
+    char m_buffer[SEND_BUFFER_SIZE];
+    Sensors::BufferSink m_sink;
+    Sensors::JsonWriter<Sensors::BufferSink> m_json;
+};
 
-        if (bmp180.read()) {
-            snprintf(str, SEND_BUFFER_SIZE,
-                     "{\"bmp180\":{\"temperature\":%.2f,\"pressure\":%.2f}}\n",
-                     static_cast<double>(bmp180.temperature()),
-                     static_cast<double>(bmp180.pressureAtSeaLevel(ALTITUDE)));
-            uart.sendString(str);
-            ethernet.sendUdpMessage(UDP_SERVER, UDP_PORT, str);
-        }
+/*!
+ * \brief Formats the values of a sensor as COBS framed binary message.
+ *
+ * Each message carries a sequence number that allows the receiver to detect
+ * lost messages. The JSON keys are ignored.
+ */
+class BinaryMessage
+{
+public:
+    BinaryMessage()
+        : m_sink(m_buffer, sizeof(m_buffer))
+    {
+    }
+
+    void begin(Sensors::FlashString, Sensors::WireSensor sensor)
+    {
+        begin(sensor, 0);
+    }
+
+    void begin(Sensors::FlashString, Sensors::WireSensor sensor,
+               uint8_t channel)
+    {
+        begin(sensor, channel);
+    }
+
+    template <uint8_t TDigits>
+    void addValue(Sensors::FlashString, Sensors::WireQuantity quantity,
+                  Sensors::FixedPoint<TDigits> value)
+    {
+        m_frame.add(m_sensorId, quantity, value);
+    }
+
+    void addUInt(Sensors::FlashString, Sensors::WireQuantity quantity,
+                 uint32_t value)
+    {
+        // Fixed point values are signed, counters saturate at INT32_MAX
+        int32_t clamped = value > INT32_MAX ? INT32_MAX : value;
+        m_frame.add(m_sensorId, quantity, Sensors::FixedPoint<0>(clamped));
+    }
+
+    void addBool(Sensors::FlashString, Sensors::WireQuantity quantity,
+                 bool value)
+    {
+        m_frame.add(m_sensorId, quantity, Sensors::FixedPoint<0>(value));
+    }
+
+    void end()
+    {
+        m_frame.encode(m_sink);
+        TRACE_END(Sensors::TraceEvent::Format);
+    }
+
+    const uint8_t *data() const
+    {
+        return reinterpret_cast<const uint8_t *>(m_buffer);
+    }
+
+    uint16_t length() const
+    {
+        return m_sink.length();
+    }
+
+private:
+    void begin(Sensors::WireSensor sensor, uint8_t channel)
+    {
+        TRACE_BEGIN(Sensors::TraceEvent::Format);
+        m_sensorId = Sensors::wireSensorId(sensor, channel);
+        m_frame.begin(s_sequence++);
+    }
+
+    static uint8_t s_sequence;
+
+    // Worst case COBS overhead, delimiter and null-terminator of the sink
+    char m_buffer[WIRE_FRAME_SIZE + 3];
+    Sensors::BufferSink m_sink;
+    Sensors::WireFrame<WIRE_FRAME_SIZE> m_frame;
+    uint8_t m_sensorId = 0;
+};
+
+uint8_t BinaryMessage::s_sequence = 0;
+
+#ifdef WIRE_FORMAT_BINARY
+using Message = BinaryMessage;
+#else
+using Message = JsonMessage;
+#endif
+
+#ifdef OUTPUT_UART
+static Avr::UartSink<BAUD, UART_QUEUE_SIZE> s_uartSink;
+#endif
+
+#ifdef OUTPUT_UDP
+using UdpSink = Avr::UdpSink<UdpBatch, UDP_QUEUE_SIZE, SEND_BUFFER_SIZE>;
+
+/*!
+ * \brief Returns the UDP sink used for all messages.
+ *
+ * The Ethernet interface is initialized on the first call.
+ *
+ * \return The UDP sink.
+ */
+static UdpSink &udpSink()
+{
+    static Ethernet ethernet(ETHERNET_MAC, ETHERNET_IP, ETHERNET_SUBNET);
+    static UdpBatch batch(ethernet, UDP_SERVER, UDP_PORT);
+    static UdpSink sink(batch);
+    return sink;
+}
+#endif
+
+/*!
+ * \brief Queues the \p message for all output sinks enabled with the
+ *        `OUTPUT_UART` and `OUTPUT_UDP` build options.
+ *
+ * Returns immediately, the sinks are drained by their own tasks. Messages
+ * are dropped if a sink cannot keep up.
+ *
+ * \param message The message to send.
+ */
+static void sendMessage(const Message &message)
+{
+#ifdef OUTPUT_UART
+    s_uartSink.add(message.data(), message.length());
+#endif
+#ifdef OUTPUT_UDP
+    TRACE_SCOPE(Sensors::TraceEvent::Udp);
+    udpSink().add(message.data(), message.length());
+#endif
+#if !defined(OUTPUT_UART) && !defined(OUTPUT_UDP)
+    (void)message;
+#endif
+}
+
+#ifdef OUTPUT_UART
+/*!
+ * \brief Task: Passes queued messages to the UART interface.
+ */
+static void drainUart()
+{
+    TRACE_SCOPE(Sensors::TraceEvent::Uart);
+    s_uartSink.drain();
+}
+#endif
+
+#ifdef OUTPUT_UDP
+/*!
+ * \brief Readiness callback for drainUdp().
+ *
+ * \return `true` if messages are queued and the UDP batch accepts them.
+ */
+static bool isUdpSinkReady()
+{
+    return udpSink().isReady();
+}
+
+/*!
+ * \brief Task: Adds the queued messages to the UDP datagram once the
+ *        previous datagram has been transmitted.
+ */
+static void drainUdp()
+{
+    TRACE_SCOPE(Sensors::TraceEvent::Udp);
+    udpSink().drain();
+}
+
+/*!
+ * \brief Task: Sends the current UDP datagram.
+ *
+ * If a previous datagram is still being transmitted, the datagram is sent
+ * on the next run.
+ */
+static void flushUdpMessages()
+{
+    UdpBatch &batch = udpSink().batch();
+    if (!batch.isBusy()) {
+        TRACE_SCOPE(Sensors::TraceEvent::Udp);
+        batch.flush();
+    }
+}
+#endif
+
+/*!
+ * \brief Transmits the values received from a Hideki sensor.
+ *
+ * \param sensor The values to send.
+ */
+static void sendHidekiMessage(const Sensors::HidekiData &sensor)
+{
+    Message message;
+    message.begin(FLASH_STRING("rf433_"), Sensors::WireSensor::Rf433,
+                  sensor.channel());
+    message.addValue(FLASH_STRING("temperature"),
+                     Sensors::WireQuantity::Temperature,
+                     sensor.temperatureFixed());
+    message.addUInt(FLASH_STRING("humidity"),
+                    Sensors::WireQuantity::Humidity, sensor.humidity());
+    message.addBool(FLASH_STRING("battery"),
+                    Sensors::WireQuantity::Battery, sensor.batteryOk());
+    message.end();
+    sendMessage(message);
+}
+
+/*!
+ * \brief Removes the oldest reading from the Hideki queue.
+ *
+ * Readings that have been queued for longer than `RF_MAX_LATENCY` are
+ * counted as late.
+ *
+ * \param sensor Memory location the reading is stored into.
+ * \return `true` if a reading has been removed, `false` if the queue is
+ *         empty.
+ */
+static bool popHidekiData(Sensors::HidekiData &sensor)
+{
+    HidekiReading reading;
+    if (!s_hidekiQueue.pop(reading))
+        return false;
+
+    uint16_t now = Avr::SystemClock::instance().millis();
+    if (static_cast<uint16_t>(now - reading.decoded) > RF_MAX_LATENCY)
+        count(&HealthCounters::rfLate);
+    sensor = reading.data;
+    return true;
+}
+
+#ifdef RF_FORWARD_IMMEDIATE
+/*!
+ * \brief Readiness callback for forwardHidekiData().
+ *
+ * \return `true` if a Hideki reading is queued and the UDP batch accepts
+ *         messages.
+ */
+static bool isHidekiDataQueued()
+{
+#ifdef OUTPUT_UDP
+    if (udpSink().batch().isBusy())
+        return false;
+#endif
+    return !s_hidekiQueue.isEmpty();
+}
+
+/*!
+ * \brief Task: Transmits the oldest queued Hideki reading and sends the UDP
+ *        datagram right away.
+ *
+ * Only runs while the UDP batch accepts messages so that it never has to
+ * wait for the Ethernet module.
+ */
+static void forwardHidekiData()
+{
+    Sensors::HidekiData sensor;
+    if (popHidekiData(sensor)) {
+#ifdef OUTPUT_UDP
+        // Older queued messages have to be added first to keep the order
+        drainUdp();
+#endif
+        sendHidekiMessage(sensor);
+#ifdef OUTPUT_UDP
+        flushUdpMessages();
+#endif
+    }
+}
+#else
+/*!
+ * \brief Readiness callback for collectHidekiData().
+ *
+ * \return `true` if a Hideki reading is queued.
+ */
+static bool isHidekiDataQueued()
+{
+    return !s_hidekiQueue.isEmpty();
+}
+
+/*!
+ * \brief Task: Stores the queued Hideki readings as latest reading of their
+ *        channel.
+ */
+static void collectHidekiData()
+{
+    Sensors::HidekiData sensor;
+    while (popHidekiData(sensor)) {
+        s_hidekiData[sensor.channel()-1] = sensor;
+    }
+}
 
-        if (mlx90614.read()) {
-            snprintf(str, SEND_BUFFER_SIZE,
-                     "{\"mlx90614\":{\"ambient_temperature\":%.2f,"
-                     "\"objectTemperature\":%.2f}}\n",
-                     static_cast<double>(mlx90614.ambientTemperature()),
-                     static_cast<double>(mlx90614.objectTemperature()));
-            uart.sendString(str);
-            ethernet.sendUdpMessage(UDP_SERVER, UDP_PORT, str);
+/*!
+ * \brief Task: Transmits the latest values received from the Hideki
+ *        sensors.
+ */
+static void sendHidekiData()
+{
+    for (auto &sensor : s_hidekiData) {
+        if (sensor.isValid()) {
+            sendHidekiMessage(sensor);
+            sensor.reset();
         }
+    }
+}
+#endif
 
-        uint16_t vout = Avr::Adc::instance().readMilliVolts(0, 5);
-        snprintf(str, SEND_BUFFER_SIZE,
-                 "{\"tgs2600\":{\"sensor_resistance\":%ld,"
-                 "\"sensor_resistance_calibrated\":%ld}}\n",
-                 tgs2600.sensorResistance(vout),
-                 tgs2600.sensorResistanceCalibrated(vout));
-        uart.sendString(str);
-        ethernet.sendUdpMessage(UDP_SERVER, UDP_PORT, str);
+static bool s_dht22Pending = false;
 
-        _delay_ms(DELAY);
+/*!
+ * \brief Task: Starts a DHT22 measurement.
+ *
+ * Without DHT22_CAPTURE, the sensor is read immediately.
+ */
+static void startDht22()
+{
+#ifdef DHT22_CAPTURE
+    s_dht22.begin();
+#else
+    s_dht22.read();
+#endif
+    s_dht22Pending = true;
+}
+
+/*!
+ * \brief Readiness callback for sendDht22().
+ *
+ * \return `true` if the DHT22 measurement is completed.
+ */
+static bool isDht22Ready()
+{
+#ifdef DHT22_CAPTURE
+    return s_dht22Pending && s_dht22.poll() != Avr::Dht22Status::Pending;
+#else
+    return s_dht22Pending;
+#endif
+}
+
+/*!
+ * \brief Task: Transmits the DHT22 measurement.
+ */
+static void sendDht22()
+{
+    s_dht22Pending = false;
+#ifdef DHT22_CAPTURE
+    if (s_dht22.poll() == Avr::Dht22Status::Timeout)
+        count(&HealthCounters::dht22Timeouts);
+    else if (!s_dht22.isValid())
+        count(&HealthCounters::dht22Errors);
+#else
+    if (!s_dht22.isValid())
+        count(&HealthCounters::dht22Errors);
+#endif
+    if (s_dht22.isValid()) {
+        Message message;
+        message.begin(FLASH_STRING("dht22"), Sensors::WireSensor::Dht22);
+        message.addValue(FLASH_STRING("temperature"),
+                         Sensors::WireQuantity::Temperature,
+                         s_dht22.temperature());
+        message.addValue(FLASH_STRING("humidity"),
+                         Sensors::WireQuantity::Humidity,
+                         s_dht22.humidity());
+        message.end();
+        sendMessage(message);
+
+        s_tgs2600.setReferenceTemperature(s_dht22.temperature());
+        s_tgs2600.setReferenceHumidity(s_dht22.humidity());
+    }
+}
+
+static bool s_bmp180Pending = false;
+
+/*!
+ * \brief Task: Starts a BMP180 measurement in the background.
+ */
+static void startBmp180()
+{
+    s_bmp180.startConversion();
+    s_bmp180Pending = true;
+}
+
+/*!
+ * \brief Readiness callback for sendBmp180().
+ *
+ * \return `true` if the BMP180 measurement is completed.
+ */
+static bool isBmp180Ready()
+{
+    return s_bmp180Pending && s_bmp180.poll() != Avr::TwiStatus::Pending;
+}
+
+/*!
+ * \brief Task: Transmits the BMP180 measurement.
+ */
+static void sendBmp180()
+{
+    s_bmp180Pending = false;
+    if (!s_bmp180.isValid())
+        count(&HealthCounters::twiErrors);
+    if (s_bmp180.isValid()) {
+        Message message;
+        message.begin(FLASH_STRING("bmp180"), Sensors::WireSensor::Bmp180);
+        message.addValue(FLASH_STRING("temperature"),
+                         Sensors::WireQuantity::Temperature,
+                         s_bmp180.temperature());
+        message.addValue(FLASH_STRING("pressure"),
+                         Sensors::WireQuantity::Pressure,
+                         s_bmp180.pressureAtSeaLevel<ALTITUDE>());
+        message.end();
+        sendMessage(message);
+    }
+}
+
+static bool s_mlx90614Pending = false;
+
+/*!
+ * \brief Task: Starts a MLX90614 measurement in the background.
+ */
+static void startMlx90614()
+{
+    s_mlx90614.begin();
+    s_mlx90614Pending = true;
+}
+
+/*!
+ * \brief Readiness callback for sendMlx90614().
+ *
+ * \return `true` if the MLX90614 measurement is completed.
+ */
+static bool isMlx90614Ready()
+{
+    return s_mlx90614Pending &&
+           s_mlx90614.poll() != Avr::TwiStatus::Pending;
+}
+
+/*!
+ * \brief Task: Transmits the MLX90614 measurement.
+ */
+static void sendMlx90614()
+{
+    s_mlx90614Pending = false;
+    if (!s_mlx90614.isValid())
+        count(&HealthCounters::twiErrors);
+    if (s_mlx90614.isValid()) {
+        Message message;
+        message.begin(FLASH_STRING("mlx90614"),
+                      Sensors::WireSensor::Mlx90614);
+        message.addValue(FLASH_STRING("ambient_temperature"),
+                         Sensors::WireQuantity::AmbientTemperature,
+                         s_mlx90614.ambientTemperature());
+        message.addValue(FLASH_STRING("objectTemperature"),
+                         Sensors::WireQuantity::ObjectTemperature,
+                         s_mlx90614.objectTemperature());
+        message.end();
+        sendMessage(message);
+    }
+}
+
+/*!
+ * \brief Task: Reads and transmits the TGS 2600 sensor resistance.
+ */
+static void sendTgs2600()
+{
+    uint16_t vout = Avr::Adc::instance().readMilliVolts(0, 5);
+    Message message;
+    message.begin(FLASH_STRING("tgs2600"), Sensors::WireSensor::Tgs2600);
+    message.addUInt(FLASH_STRING("sensor_resistance"),
+                    Sensors::WireQuantity::Resistance,
+                    s_tgs2600.sensorResistance(vout));
+    message.addUInt(FLASH_STRING("sensor_resistance_calibrated"),
+                    Sensors::WireQuantity::ResistanceCalibrated,
+                    s_tgs2600.sensorResistanceCalibrated(vout));
+    message.end();
+    sendMessage(message);
+}
+
+/*!
+ * \brief Messages of the report, transmitted one at a time by
+ *        sendReportMessage().
+ */
+enum class ReportMessage : uint8_t {
+    Cpu,
+    Memory,
+    RfReceiver,
+    RfPulses,     //!< Only with `HEALTH_STATISTICS`
+    RfFrames,     //!< Only with `HEALTH_STATISTICS`
+    Dht22Status,  //!< Only with `HEALTH_STATISTICS`
+    Twi,          //!< Only with `HEALTH_STATISTICS`
+    Uart,         //!< Only with `HEALTH_STATISTICS` and `OUTPUT_UART`
+    Udp,          //!< Only with `HEALTH_STATISTICS` and `OUTPUT_UDP`
+    Tasks         //!< Followed by one message per task
+};
+
+static const uint8_t REPORT_IDLE = 0xFF;
+// Next ReportMessage (or task) to transmit, REPORT_IDLE if the report is done
+static uint8_t s_reportIndex = REPORT_IDLE;
+// Avr::SystemClock::millis() when the next report starts
+static uint32_t s_reportDue = 0;
+
+#ifdef HEALTH_STATISTICS
+// Counters at the start of the report, transmitted over multiple messages
+static Sensors::RfDeviceCounters s_reportDecoder;
+static HealthCounters s_reportHealth;
+#ifdef RF_CAPTURE_BUFFERED
+// The pulse buffer overflows can't be reset, the report takes the difference
+static uint16_t s_reportOverflows = 0;
+static uint16_t s_lastOverflows = 0;
+#endif
+#endif
+
+/*!
+ * \brief Starts transmitting the CPU load, the memory usage, the RF
+ *        receiver and health counters and the runtime statistics of all
+ *        tasks.
+ *
+ * The counters that are shared with the RF decoder are copied and reset at
+ * once. The messages are transmitted by sendReportMessage().
+ */
+static void startReport()
+{
+#ifdef HEALTH_STATISTICS
+    {
+        // The RF decoder may run in the input capture ISR
+        Avr::AtomicGuard<Avr::AtomicRestoreState> atomicGuard;
+        s_reportDecoder = s_hidekiDevice.statistics();
+        s_hidekiDevice.resetStatistics();
+        s_reportHealth = s_health;
+        s_health = HealthCounters();
+    }
+#ifdef RF_CAPTURE_BUFFERED
+    uint16_t overflows = CaptureObserver::overflows();
+    s_reportOverflows = overflows - s_lastOverflows;
+    s_lastOverflows = overflows;
+#endif
+#endif
+    s_reportIndex = 0;
+}
+
+/*!
+ * \brief Readiness callback for sendReportMessage().
+ *
+ * Starts the report every `REPORT_INTERVAL` (in ms). This saves a separate
+ * periodic task.
+ *
+ * \return `true` if the report is not done and the output queues are
+ *         empty.
+ */
+static bool isReportPending()
+{
+    if (s_reportIndex == REPORT_IDLE) {
+        uint32_t now = Avr::SystemClock::instance().millis();
+        if (static_cast<int32_t>(now - s_reportDue) < 0)
+            return false;
+
+        // Keep the interval stable, skip reports that have been missed
+        s_reportDue += REPORT_INTERVAL;
+        if (static_cast<int32_t>(now - s_reportDue) >= 0)
+            s_reportDue = now + REPORT_INTERVAL;
+        startReport();
+    }
+#ifdef OUTPUT_UART
+    if (!s_uartSink.isEmpty())
+        return false;
+#endif
+#ifdef OUTPUT_UDP
+    if (!udpSink().isEmpty())
+        return false;
+#endif
+    return true;
+}
+
+/*!
+ * \brief Transmits the health counter message \p part and resets the
+ *        counters of the outputs.
+ *
+ * Does nothing without the `HEALTH_STATISTICS` build option.
+ *
+ * \param part The message to transmit.
+ */
+static void sendHealthMessage(ReportMessage part)
+{
+#ifdef HEALTH_STATISTICS
+    const Sensors::RfDeviceCounters &decoder = s_reportDecoder;
+    const HealthCounters &health = s_reportHealth;
+    Message message;
+    switch (part) {
+    case ReportMessage::RfPulses:
+        message.begin(FLASH_STRING("rf_pulses"),
+                      Sensors::WireSensor::RfReceiver);
+        message.addUInt(FLASH_STRING("pulses"),
+                        Sensors::WireQuantity::Pulses, decoder.pulses);
+        message.addUInt(FLASH_STRING("demodulator_errors"),
+                        Sensors::WireQuantity::DemodulatorErrors,
+                        decoder.demodulatorErrors);
+        message.addUInt(FLASH_STRING("parity_errors"),
+                        Sensors::WireQuantity::ParityErrors,
+                        decoder.parityErrors);
+#ifdef RF_CAPTURE_BUFFERED
+        message.addUInt(FLASH_STRING("overflows"),
+                        Sensors::WireQuantity::Overflows,
+                        s_reportOverflows);
+#endif
+        break;
+    case ReportMessage::RfFrames:
+        message.begin(FLASH_STRING("rf_frames"),
+                      Sensors::WireSensor::RfReceiver);
+        message.addUInt(FLASH_STRING("frames"),
+                        Sensors::WireQuantity::Frames, decoder.frames);
+        message.addUInt(FLASH_STRING("too_much_data"),
+                        Sensors::WireQuantity::TooMuchData,
+                        decoder.tooMuchData);
+        message.addUInt(FLASH_STRING("invalid_data"),
+                        Sensors::WireQuantity::InvalidData,
+                        decoder.invalidData);
+        message.addUInt(FLASH_STRING("dropped"),
+                        Sensors::WireQuantity::Dropped, health.rfDropped);
+        message.addUInt(FLASH_STRING("late"),
+                        Sensors::WireQuantity::DeadlineMisses,
+                        health.rfLate);
+        break;
+    case ReportMessage::Dht22Status:
+        message.begin(FLASH_STRING("dht22_status"),
+                      Sensors::WireSensor::Dht22);
+        message.addUInt(FLASH_STRING("errors"),
+                        Sensors::WireQuantity::Errors, health.dht22Errors);
+        message.addUInt(FLASH_STRING("timeouts"),
+                        Sensors::WireQuantity::Timeouts,
+                        health.dht22Timeouts);
+        break;
+    case ReportMessage::Twi:
+        message.begin(FLASH_STRING("i2c"), Sensors::WireSensor::Twi);
+        message.addUInt(FLASH_STRING("errors"),
+                        Sensors::WireQuantity::Errors, health.twiErrors);
+        break;
+#ifdef OUTPUT_UART
+    case ReportMessage::Uart:
+        message.begin(FLASH_STRING("uart"), Sensors::WireSensor::Uart);
+        message.addUInt(FLASH_STRING("dropped"),
+                        Sensors::WireQuantity::Dropped,
+                        s_uartSink.dropped());
+        s_uartSink.resetStatistics();
+        break;
+#endif
+#ifdef OUTPUT_UDP
+    case ReportMessage::Udp: {
+        UdpSink &sink = udpSink();
+        UdpBatch &batch = sink.batch();
+        message.begin(FLASH_STRING("udp"), Sensors::WireSensor::Udp);
+        message.addUInt(FLASH_STRING("timeouts"),
+                        Sensors::WireQuantity::Timeouts, batch.timeouts());
+        message.addUInt(FLASH_STRING("dropped"),
+                        Sensors::WireQuantity::Dropped,
+                        static_cast<uint32_t>(batch.dropped()) +
+                            sink.dropped());
+        batch.resetStatistics();
+        sink.resetStatistics();
+        break;
+    }
+#endif
+    default:
+        return;
+    }
+    message.end();
+    sendMessage(message);
+#else
+    (void)part;
+#endif
+}
+
+/*!
+ * \brief Transmits the runtime statistics of the task with the given
+ *        \p index and resets them.
+ *
+ * \param index The index of the task.
+ */
+static void sendTaskStatistics(uint8_t index)
+{
+    const Avr::TaskStatistics &statistics = s_scheduler.statistics(index);
+    Message message;
+    message.begin(FLASH_STRING("task_"), Sensors::WireSensor::Task, index);
+    message.addUInt(FLASH_STRING("runs"), Sensors::WireQuantity::Runs,
+                    statistics.runs);
+    message.addUInt(FLASH_STRING("runtime_avg_us"),
+                    Sensors::WireQuantity::RuntimeAverage,
+                    statistics.averageRuntime());
+    message.addUInt(FLASH_STRING("runtime_max_us"),
+                    Sensors::WireQuantity::RuntimeMax,
+                    statistics.maxRuntime);
+    message.addUInt(FLASH_STRING("deadline_misses"),
+                    Sensors::WireQuantity::DeadlineMisses,
+                    statistics.deadlineMisses);
+    message.end();
+    sendMessage(message);
+    s_scheduler.resetStatistics(index);
+}
+
+/*!
+ * \brief Task: Transmits the next message of the report started by
+ *        startReport().
+ *
+ * Only one message is transmitted per run and only while the output queues
+ * are empty, so the report never pushes sensor readings out of the queues.
+ */
+static void sendReportMessage()
+{
+    uint8_t index = s_reportIndex++;
+    switch (static_cast<ReportMessage>(index)) {
+    case ReportMessage::Cpu: {
+        Avr::Sleep &sleep = Avr::Sleep::instance();
+        Message message;
+        message.begin(FLASH_STRING("cpu"), Sensors::WireSensor::System);
+        message.addUInt(FLASH_STRING("sleep_ms"),
+                        Sensors::WireQuantity::SleepTime, sleep.sleepTime());
+        message.addUInt(FLASH_STRING("work_ms"),
+                        Sensors::WireQuantity::WorkTime, sleep.workTime());
+        message.end();
+        sendMessage(message);
+        sleep.resetStatistics();
+        break;
+    }
+    case ReportMessage::Memory: {
+        Message message;
+        message.begin(FLASH_STRING("memory"), Sensors::WireSensor::System);
+        message.addUInt(FLASH_STRING("static_bytes"),
+                        Sensors::WireQuantity::StaticMemory,
+                        Avr::Memory::staticSize());
+        message.addUInt(FLASH_STRING("stack_max_bytes"),
+                        Sensors::WireQuantity::StackMax,
+                        Avr::Memory::stackMax());
+        message.addUInt(FLASH_STRING("stack_unused_bytes"),
+                        Sensors::WireQuantity::StackUnused,
+                        Avr::Memory::stackUnused());
+        message.end();
+        sendMessage(message);
+        break;
+    }
+    case ReportMessage::RfReceiver: {
+        Avr::TimerStormStatistics storm = InputCapture::stormStatistics();
+        Message message;
+        message.begin(FLASH_STRING("rf_receiver"),
+                      Sensors::WireSensor::RfReceiver);
+        message.addUInt(FLASH_STRING("storms"),
+                        Sensors::WireQuantity::Storms, storm.storms);
+        message.addUInt(FLASH_STRING("backoffs"),
+                        Sensors::WireQuantity::Backoffs, storm.backoffs);
+        message.addUInt(FLASH_STRING("glitches"),
+                        Sensors::WireQuantity::Glitches, storm.glitches);
+        message.end();
+        sendMessage(message);
+        break;
+    }
+    case ReportMessage::RfPulses:
+    case ReportMessage::RfFrames:
+    case ReportMessage::Dht22Status:
+    case ReportMessage::Twi:
+    case ReportMessage::Uart:
+    case ReportMessage::Udp:
+        sendHealthMessage(static_cast<ReportMessage>(index));
+        break;
+    default: {
+        uint8_t task = index - static_cast<uint8_t>(ReportMessage::Tasks);
+        sendTaskStatistics(task);
+        if (task + 1 >= s_scheduler.size())
+            s_reportIndex = REPORT_IDLE;
+        break;
+    }
+    }
+}
+
+#ifdef TRACE
+/*!
+ * \brief Transmits \p value as hexadecimal number with \p digits digits.
+ *
+ * \param value The value to send.
+ * \param digits The number of digits (with leading zeros).
+ */
+static void sendHex(uint16_t value, uint8_t digits)
+{
+    auto &uart = Avr::Uart<BAUD>::instance();
+    while (digits--) {
+        uint8_t digit = (value >> (digits * 4)) & 0x0F;
+        uart.sendChar(digit < 10 ? '0' + digit : 'a' + digit - 10);
+    }
+}
+
+/*!
+ * \brief Task: Dumps and clears the trace buffer when `t` has been received
+ *        on the UART interface.
+ *
+ * The dump format is described in \ref libsensors_trace.
+ */
+static void dumpTrace()
+{
+    auto &uart = Avr::Uart<BAUD>::instance();
+#ifdef OUTPUT_UART
+    // Don't interrupt messages that are being transmitted
+    if (!s_uartSink.isEmpty())
+        return;
+#endif
+    unsigned char c;
+    if (!uart.receiveChar(c) || c != 't')
+        return;
+
+    Avr::Trace::Buffer trace = Avr::Trace::take();
+    uart.sendString(FLASH_STRING("TRACE "));
+    uart.sendUInt(trace.size());
+    uart.sendChar('\n');
+    for (uint8_t index = 0; index < trace.size(); ++index) {
+        sendHex(trace[index].event, 2);
+        uart.sendChar(' ');
+        sendHex(trace[index].timestamp, 4);
+        uart.sendChar('\n');
+    }
+    uart.sendLine(FLASH_STRING("TRACE END"));
+}
+#endif
+
+/*!
+ * \brief Application entry point.
+ *
+ * \return As main application, this function does not return.
+ */
+int main()
+{
+    InputCapture::instance();
+
+    sei();  // Enable interrupts
+
+#ifdef OUTPUT_UART
+    // Arduino boards restart when a serial connection is established (DTR).
+    // Transmitting an initial string allows the client to know that the
+    // microcontroller is ready.
+    auto &uart = Avr::Uart<BAUD>::instance();
+    uart.sendLine(FLASH_STRING("VERSION: " GIT_VERSION));
+    uart.sendLine(FLASH_STRING("READY"));
+#endif
+
+#ifdef OUTPUT_UDP
+    udpSink();
+#ifdef OUTPUT_UART
+    uart.sendLine(FLASH_STRING("ETHERNET READY"));
+#endif
+#endif
+
+#ifdef RF_CAPTURE_BUFFERED
+    s_scheduler.add(processPulseWidths, PULSE_PROCESSING_INTERVAL);
+#endif
+#ifdef RF_FORWARD_IMMEDIATE
+    s_scheduler.add(forwardHidekiData, 0, RF_MAX_LATENCY,
+                    isHidekiDataQueued);
+#else
+    s_scheduler.add(collectHidekiData, 0, RF_MAX_LATENCY, isHidekiDataQueued);
+    s_scheduler.add(sendHidekiData, RF_INTERVAL);
+#endif
+    s_scheduler.add(startDht22, DHT22_INTERVAL, 0, nullptr, DHT22_OFFSET);
+    s_scheduler.add(sendDht22, 0, OUTPUT_DEADLINE, isDht22Ready);
+    s_scheduler.add(startBmp180, BMP180_INTERVAL, 0, nullptr, BMP180_OFFSET);
+    s_scheduler.add(sendBmp180, 0, OUTPUT_DEADLINE, isBmp180Ready);
+    s_scheduler.add(startMlx90614, MLX90614_INTERVAL, 0, nullptr,
+                    MLX90614_OFFSET);
+    s_scheduler.add(sendMlx90614, 0, OUTPUT_DEADLINE, isMlx90614Ready);
+    s_scheduler.add(sendTgs2600, TGS2600_INTERVAL, 0, nullptr,
+                    TGS2600_OFFSET);
+#ifdef OUTPUT_UART
+    s_scheduler.add(drainUart, UART_DRAIN_INTERVAL);
+#endif
+#ifdef OUTPUT_UDP
+    s_scheduler.add(drainUdp, 0, OUTPUT_DEADLINE, isUdpSinkReady);
+    s_scheduler.add(flushUdpMessages, FLUSH_INTERVAL);
+#endif
+    s_reportDue = Avr::SystemClock::instance().millis() + REPORT_OFFSET;
+    s_scheduler.add(sendReportMessage, 0, REPORT_DEADLINE, isReportPending);
+#ifdef TRACE
+    s_scheduler.add(dumpTrace, TRACE_POLL_INTERVAL);
+#endif
+
+    Avr::Sleep::instance().resetStatistics();
+    while (true) {
+        if (!s_scheduler.runOnce()) {
+            Avr::Sleep::instance().idle();
+        }
     }
 
     return 0;
@@ -0,0 +1,127 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_tests
+ *
+ * \brief Unit tests for Sensors::Bmp180Compensation.
+ */
+
+#include <tuple>
+
+#include <catch.hpp>
+
+#include "lib/bmp180compensation.h"
+
+using ::Sensors::Bmp180Compensation;
+using ::Sensors::SensorValue;
+
+namespace
+{
+// Converts calibration coefficients into the EEPROM representation
+void toEeprom(const int32_t (&coefficients)[11], uint8_t *data)
+{
+    for (uint8_t i = 0; i < 11; ++i) {
+        data[2 * i] = static_cast<uint16_t>(coefficients[i]) >> 8;
+        data[2 * i + 1] = static_cast<uint16_t>(coefficients[i]) & 0xFF;
+    }
+}
+}  // namespace
+
+/*!
+ * \brief Tests Sensors::Bmp180Compensation with the example calculation
+ *        from the BMP180 datasheet.
+ */
+TEST_CASE("Bmp180CompensationDatasheet", "[bmp180compensation]")
+{
+    // AC1 - AC6, B1, B2, MB, MC, MD
+    const int32_t coefficients[11] = {
+        408, -72, -14383, 32741, 32757, 23153, 6190, 4, -32768, -8711, 2868
+    };
+    uint8_t eeprom[Bmp180Compensation::c_calibrationSize];
+    toEeprom(coefficients, eeprom);
+
+    Bmp180Compensation compensation;
+    compensation.setCalibration(eeprom);
+    compensation.calculate(27898, 23843UL << 8, 0);
+    CHECK(compensation.temperature() == SensorValue::fromRaw(1500));
+    CHECK(compensation.pressure() == SensorValue::fromRaw(69964));
+}
+
+/*!
+ * \brief Parameterized test for Sensors::Bmp180Compensation with raw values
+ *        of a real sensor and all oversampling settings.
+ */
+TEST_CASE("Bmp180CompensationGolden", "[bmp180compensation]")
+{
+    const int32_t coefficients[11] = {
+        7911, -934, -14306, 31567, 25671, 18974, 5498, 46, -32768, -11075, 2432
+    };
+    uint8_t eeprom[Bmp180Compensation::c_calibrationSize];
+    toEeprom(coefficients, eeprom);
+
+    Bmp180Compensation compensation;
+    compensation.setCalibration(eeprom);
+
+    // UT, UP, OSS, temperature (0.01 °C), pressure (Pa)
+    using Golden = std::tuple<uint16_t, uint32_t, uint8_t, int32_t, int32_t>;
+    const Golden goldens[] = {
+        Golden(27600, 0x9C4A80, 3, 2680, 102167),
+        Golden(27600, 0x9A1040, 0, 2680, 100349),
+        Golden(24300, 0x98D2C0, 3, 460, 93403),
+        Golden(30500, 0x95E3A0, 2, 4410, 101512),
+        Golden(20000, 0xB0A480, 1, -3880, 98954),
+    };
+
+    for (const auto &golden : goldens) {
+        compensation.calculate(std::get<0>(golden), std::get<1>(golden),
+                               std::get<2>(golden));
+        CHECK(compensation.temperature().raw() == std::get<3>(golden));
+        CHECK(compensation.pressure().raw() == std::get<4>(golden));
+    }
+}
+
+/*!
+ * \brief Tests Sensors::Bmp180Compensation::seaLevelFactor() and
+ *        Sensors::Bmp180Compensation::pressureAtSeaLevel().
+ */
+TEST_CASE("Bmp180CompensationSeaLevel", "[bmp180compensation]")
+{
+    CHECK(Bmp180Compensation::seaLevelFactor<0>().raw() == 10000);
+    CHECK(Bmp180Compensation::seaLevelFactor<470>().raw() == 10576);
+    CHECK(Bmp180Compensation::seaLevelFactor<1000>().raw() == 11274);
+    CHECK(Bmp180Compensation::seaLevelFactor<3000>().raw() == 14452);
+    CHECK(Bmp180Compensation::seaLevelFactor<-100>().raw() == 9882);
+    CHECK(Bmp180Compensation::seaLevelFactorRaw(470) == 10576);
+
+    Bmp180Compensation compensation;
+    const int32_t coefficients[11] = {
+        408, -72, -14383, 32741, 32757, 23153, 6190, 4, -32768, -8711, 2868
+    };
+    uint8_t eeprom[Bmp180Compensation::c_calibrationSize];
+    toEeprom(coefficients, eeprom);
+    compensation.setCalibration(eeprom);
+    compensation.calculate(27898, 23843UL << 8, 0);
+
+    // 699.64 hPa * 1.0576
+    CHECK(compensation.pressureAtSeaLevel(
+              Bmp180Compensation::seaLevelFactor<470>()) ==
+          SensorValue::fromRaw(73994));
+}
@@ -0,0 +1,167 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_tests
+ *
+ * \brief Unit tests for Sensors::cobsEncode() and Sensors::cobsDecode().
+ */
+
+#include <vector>
+
+#include <catch.hpp>
+
+#include "lib/cobs.h"
+
+using ::Sensors::cobsDecode;
+using ::Sensors::cobsEncode;
+
+namespace
+{
+struct VectorSink
+{
+    void write(char c)
+    {
+        data.push_back(static_cast<uint8_t>(c));
+    }
+
+    std::vector<uint8_t> data;
+};
+
+std::vector<uint8_t> encode(const std::vector<uint8_t> &data)
+{
+    VectorSink sink;
+    cobsEncode(data.data(), data.size(), sink);
+    return sink.data;
+}
+
+std::vector<uint8_t> decode(const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> output(data.size());
+    int16_t length = cobsDecode(data.data(), data.size(), output.data());
+    output.resize(length < 0 ? 0 : length);
+    return output;
+}
+
+std::vector<uint8_t> sequence(uint16_t length, uint8_t first)
+{
+    std::vector<uint8_t> data;
+    for (uint16_t i = 0; i < length; ++i) {
+        data.push_back(first + i);
+    }
+    return data;
+}
+}  // namespace
+
+/*!
+ * \brief Tests Sensors::cobsEncode() and Sensors::cobsDecode() with the
+ *        examples from the COBS paper.
+ */
+TEST_CASE("CobsExamples", "[cobs]")
+{
+    using Bytes = std::vector<uint8_t>;
+    std::vector<std::pair<Bytes, Bytes>> examples = {
+        { {}, { 0x01 } },
+        { { 0x00 }, { 0x01, 0x01 } },
+        { { 0x00, 0x00 }, { 0x01, 0x01, 0x01 } },
+        { { 0x11, 0x22, 0x00, 0x33 }, { 0x03, 0x11, 0x22, 0x02, 0x33 } },
+        { { 0x11, 0x22, 0x33, 0x44 }, { 0x05, 0x11, 0x22, 0x33, 0x44 } },
+        { { 0x11, 0x00, 0x00, 0x00 }, { 0x02, 0x11, 0x01, 0x01, 0x01 } },
+    };
+
+    for (const auto &example : examples) {
+        CHECK(encode(example.first) == example.second);
+        CHECK(decode(example.second) == example.first);
+    }
+}
+
+/*!
+ * \brief Tests Sensors::cobsEncode() and Sensors::cobsDecode() with blocks
+ *        of 254 and more non-zero bytes.
+ */
+TEST_CASE("CobsLongBlocks", "[cobs]")
+{
+    // 254 non-zero bytes fit into a single block
+    auto data = sequence(254, 1);
+    auto encoded = encode(data);
+    REQUIRE(encoded.size() == 255);
+    CHECK(encoded[0] == 0xFF);
+    CHECK(decode(encoded) == data);
+
+    // 255 non-zero bytes need a second block
+    data = sequence(255, 1);
+    data[254] = 0xFF;
+    encoded = encode(data);
+    REQUIRE(encoded.size() == 257);
+    CHECK(encoded[0] == 0xFF);
+    CHECK(encoded[255] == 0x02);
+    CHECK(encoded[256] == 0xFF);
+    CHECK(decode(encoded) == data);
+
+    // Zero byte directly after a full block
+    data = sequence(254, 1);
+    data.push_back(0);
+    data.push_back(0x42);
+    encoded = encode(data);
+    CHECK(decode(encoded) == data);
+}
+
+/*!
+ * \brief Tests that Sensors::cobsEncode() never emits zero bytes and that
+ *        Sensors::cobsDecode() restores the data (also in place).
+ */
+TEST_CASE("CobsRoundTrip", "[cobs]")
+{
+    for (uint16_t length = 0; length < 600; length += 7) {
+        std::vector<uint8_t> data;
+        for (uint16_t i = 0; i < length; ++i) {
+            data.push_back(i % 5 == 0 ? 0 : (i * 37) & 0xFF);
+        }
+
+        auto encoded = encode(data);
+        for (uint8_t byte : encoded) {
+            REQUIRE(byte != 0);
+        }
+        CHECK(encoded.size() <= length + 1U + length / 254U + 1U);
+        CHECK(decode(encoded) == data);
+
+        int16_t decoded = cobsDecode(encoded.data(), encoded.size(),
+                                     encoded.data());
+        REQUIRE(decoded == length);
+        encoded.resize(decoded);
+        CHECK(encoded == data);
+    }
+}
+
+/*!
+ * \brief Tests Sensors::cobsDecode() with invalid input.
+ */
+TEST_CASE("CobsInvalid", "[cobs]")
+{
+    uint8_t output[8];
+
+    // Zero bytes are not allowed within the encoded data
+    const uint8_t zero[] = { 0x02, 0x11, 0x00 };
+    CHECK(cobsDecode(zero, sizeof(zero), output) == -1);
+
+    // Code points behind the end of the data
+    const uint8_t truncated[] = { 0x05, 0x11, 0x22 };
+    CHECK(cobsDecode(truncated, sizeof(truncated), output) == -1);
+}
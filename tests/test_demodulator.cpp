@@ -32,6 +32,7 @@
 using ::Sensors::Demodulator;
 using ::Sensors::DemodulatorStatus;
 using ::Sensors::BiphaseMark;
+using ::Sensors::PulseWidth;
 
 /*!
  * \brief Tests Sensors::Demodulator with Sensors::BiphaseMark configuration.
@@ -52,3 +53,27 @@ TEST_CASE("DemodulatingWithBiphaseMarkConfiguration", "[demodulator]")
         CHECK(bmc.addPulseWidth(1151) == DemodulatorStatus::OutOfRangeError);
     }
 }
+
+/*!
+ * \brief Tests Sensors::Demodulator with Sensors::PulseWidth configuration.
+ */
+TEST_CASE("DemodulatingWithPulseWidthConfiguration", "[demodulator]")
+{
+    Demodulator<PulseWidth<20, 96, 96, 200>> pwm;
+
+    SECTION("InRange Values") {
+        CHECK(pwm.addPulseWidth(52) == DemodulatorStatus::Complete);
+        CHECK(pwm.getData() == false);
+        CHECK(pwm.addPulseWidth(140) == DemodulatorStatus::Complete);
+        CHECK(pwm.getData() == true);
+        CHECK(pwm.addPulseWidth(95) == DemodulatorStatus::Complete);
+        CHECK(pwm.getData() == false);
+        CHECK(pwm.addPulseWidth(96) == DemodulatorStatus::Complete);
+        CHECK(pwm.getData() == true);
+    }
+
+    SECTION("OutOfRange Values") {
+        CHECK(pwm.addPulseWidth(19) == DemodulatorStatus::OutOfRangeError);
+        CHECK(pwm.addPulseWidth(200) == DemodulatorStatus::OutOfRangeError);
+    }
+}
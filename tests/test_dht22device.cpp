@@ -0,0 +1,169 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_tests
+ *
+ * \brief Unit tests for Sensors::Dht22Sensor and Sensors::Dht22Device.
+ */
+
+#include <vector>
+
+#include <catch.hpp>
+
+#include "lib/dht22sensor.h"
+
+using ::Sensors::Dht22Sensor;
+using ::Sensors::Dht22Device;
+using ::Sensors::RfDeviceStatus;
+using ::Sensors::SensorStatus;
+using ::Sensors::SensorValue;
+
+// Example from the datasheet: 65.2 %, 35.1 °C
+static uint8_t message1[] = {0x02, 0x8C, 0x01, 0x5F, 0xEE};
+
+// Negative temperature: 40.3 %, -10.1 °C
+static uint8_t message2[] = {0x01, 0x93, 0x80, 0x65, 0x79};
+
+// Invalid checksum
+static uint8_t message3[] = {0x02, 0x8C, 0x01, 0x5F, 0xEF};
+
+using Device = Dht22Device<10, 48, 48, 100>;
+
+// Converts a message into high pulse widths (in us) with some jitter
+static std::vector<uint16_t> pulseWidths(const uint8_t (&message)[5])
+{
+    std::vector<uint16_t> pulseWidths;
+    for (uint8_t byte : message) {
+        for (int bit = 7; bit >= 0; --bit) {
+            uint16_t jitter = pulseWidths.size() % 5;
+            pulseWidths.push_back(((byte >> bit) & 1 ? 68 : 24) + jitter);
+        }
+    }
+    return pulseWidths;
+}
+
+/*!
+ * \brief Tests Sensors::Dht22Sensor with complete messages.
+ */
+TEST_CASE("Dht22SensorSetData", "[dht22sensor]")
+{
+    Dht22Sensor sensor;
+    CHECK(sensor.isValid() == false);
+
+    SECTION("Positive temperature") {
+        CHECK(sensor.setData(message1, sizeof(message1)) ==
+              SensorStatus::Complete);
+        CHECK(sensor.isValid());
+        CHECK(sensor.humidity() == SensorValue::fromRaw(6520));
+        CHECK(sensor.temperature() == SensorValue::fromRaw(3510));
+    }
+
+    SECTION("Negative temperature") {
+        CHECK(sensor.setData(message2, sizeof(message2)) ==
+              SensorStatus::Complete);
+        CHECK(sensor.isValid());
+        CHECK(sensor.humidity() == SensorValue::fromRaw(4030));
+        CHECK(sensor.temperature() == SensorValue::fromRaw(-1010));
+    }
+
+    SECTION("Invalid checksum") {
+        CHECK(sensor.setData(message3, sizeof(message3)) ==
+              SensorStatus::InvalidData);
+        CHECK(sensor.isValid() == false);
+    }
+
+    SECTION("Incomplete message") {
+        CHECK(sensor.setData(message1, 4) == SensorStatus::Incomplete);
+        CHECK(sensor.isValid() == false);
+    }
+
+    SECTION("Too much data") {
+        uint8_t data[6] = {};
+        CHECK(sensor.setData(data, sizeof(data)) ==
+              SensorStatus::TooMuchData);
+    }
+}
+
+/*!
+ * \brief Tests Sensors::Dht22Sensor when adding single bytes.
+ */
+TEST_CASE("Dht22SensorAddByte", "[dht22sensor]")
+{
+    Dht22Sensor sensor;
+
+    for (size_t i = 0; i < sizeof(message1) - 1; ++i) {
+        CHECK(sensor.addByte(message1[i]) == SensorStatus::Incomplete);
+    }
+    CHECK(sensor.addByte(message1[4]) == SensorStatus::Complete);
+    CHECK(sensor.temperature() == SensorValue::fromRaw(3510));
+    CHECK(sensor.addByte(0) == SensorStatus::TooMuchData);
+
+    sensor.reset();
+    CHECK(sensor.isValid() == false);
+}
+
+/*!
+ * \brief Tests Sensors::Dht22Device with pulse widths of complete messages.
+ */
+TEST_CASE("Dht22DeviceReceivingMessages", "[dht22device]")
+{
+    Device device;
+
+    SECTION("Valid messages") {
+        for (auto message : {&message1, &message2}) {
+            device.reset();
+            auto widths = pulseWidths(*message);
+            for (size_t i = 0; i < widths.size() - 1; ++i) {
+                CHECK(device.addPulseWidth(widths[i]) ==
+                      RfDeviceStatus::Incomplete);
+            }
+            CHECK(device.addPulseWidth(widths.back()) ==
+                  RfDeviceStatus::Complete);
+            CHECK(device.isValid());
+        }
+        CHECK(device.temperature() == SensorValue::fromRaw(-1010));
+        CHECK(device.humidity() == SensorValue::fromRaw(4030));
+    }
+
+    SECTION("Invalid checksum") {
+        auto widths = pulseWidths(message3);
+        auto status = RfDeviceStatus::Incomplete;
+        for (auto width : widths) {
+            status = device.addPulseWidth(width);
+        }
+        CHECK(status == RfDeviceStatus::InvalidData);
+        CHECK(device.isValid() == false);
+    }
+
+    SECTION("Out of range pulse width") {
+        CHECK(device.addPulseWidth(24) == RfDeviceStatus::Incomplete);
+        CHECK(device.addPulseWidth(120) == RfDeviceStatus::InvalidData);
+
+        // A new decoder run is started automatically
+        auto widths = pulseWidths(message1);
+        auto status = RfDeviceStatus::Incomplete;
+        for (auto width : widths) {
+            status = device.addPulseWidth(width);
+        }
+        CHECK(status == RfDeviceStatus::Complete);
+        CHECK(device.humidity() == SensorValue::fromRaw(6520));
+    }
+}
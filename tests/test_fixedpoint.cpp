@@ -0,0 +1,181 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_tests
+ *
+ * \brief Unit tests for Sensors::FixedPoint.
+ */
+
+#include <string>
+
+#include <catch.hpp>
+
+#include "lib/fixedpoint.h"
+
+using ::Sensors::FixedPoint;
+using ::Sensors::SensorValue;
+
+/*! \cond */
+template <uint8_t TDigits>
+static std::string format(FixedPoint<TDigits> value)
+{
+    char str[FixedPoint<TDigits>::formatSize()];
+    value.format(str, sizeof(str));
+    return str;
+}
+/*! \endcond */
+
+/*!
+ * \brief Tests construction of Sensors::FixedPoint.
+ */
+TEST_CASE("FixedPointConstruction", "[fixedpoint]")
+{
+    CHECK(SensorValue().raw() == 0);
+    CHECK(SensorValue(25).raw() == 2500);
+    CHECK(SensorValue(-25).raw() == -2500);
+    CHECK(SensorValue::fromRaw(-2480).raw() == -2480);
+    CHECK(SensorValue::fromRaw(-2480).integer() == -24);
+    CHECK(FixedPoint<0>(7).raw() == 7);
+    CHECK(FixedPoint<4>::scale() == 10000);
+
+    // Saturation
+    CHECK(SensorValue(INT32_MAX) == SensorValue::max());
+    CHECK(SensorValue(INT32_MIN) == SensorValue::min());
+    CHECK(SensorValue::fromRaw(INT32_MIN) == SensorValue::min());
+    CHECK(SensorValue::min().raw() == -SensorValue::max().raw());
+}
+
+/*!
+ * \brief Tests Sensors::FixedPoint::fromRatio().
+ */
+TEST_CASE("FixedPointRatio", "[fixedpoint]")
+{
+    CHECK(FixedPoint<4>::fromRatio(6666, 2500).raw() == 26664);
+    CHECK(FixedPoint<4>::fromRatio(1, 3).raw() == 3333);
+    CHECK(FixedPoint<2>::fromRatio(2, 3).raw() == 66);
+    CHECK(FixedPoint<0>::fromRatio(7, 2).raw() == 3);
+    CHECK(FixedPoint<4>::fromRatio(0, 5).raw() == 0);
+    CHECK(FixedPoint<4>::fromRatio(1, 0) == FixedPoint<4>::max());
+    CHECK(FixedPoint<4>::fromRatio(UINT32_MAX, 1) == FixedPoint<4>::max());
+    CHECK(FixedPoint<2>::fromRatio(UINT32_MAX, UINT32_MAX).raw() == 100);
+    CHECK(FixedPoint<2>::fromRatio(UINT32_MAX / 2, UINT32_MAX).raw() == 49);
+}
+
+/*!
+ * \brief Tests saturating addition and subtraction of Sensors::FixedPoint.
+ */
+TEST_CASE("FixedPointAddition", "[fixedpoint]")
+{
+    auto value = SensorValue::fromRaw(2480);
+    CHECK((value + 1).raw() == 2580);
+    CHECK((value - SensorValue::fromRaw(3000)).raw() == -520);
+    CHECK((-value).raw() == -2480);
+
+    value += SensorValue::fromRaw(5);
+    CHECK(value.raw() == 2485);
+    value -= 30;
+    CHECK(value.raw() == -515);
+
+    CHECK(SensorValue::max() + 1 == SensorValue::max());
+    CHECK(SensorValue::min() - 1 == SensorValue::min());
+    CHECK(SensorValue::max() - SensorValue::min() == SensorValue::max());
+    CHECK(SensorValue::min() + SensorValue::max() == 0);
+}
+
+/*!
+ * \brief Tests saturating multiplication of Sensors::FixedPoint.
+ */
+TEST_CASE("FixedPointMultiplication", "[fixedpoint]")
+{
+    // Results are rounded to the digits of the left hand side
+    CHECK((FixedPoint<4>::fromRaw(72) * SensorValue(37)).raw() == 2664);
+    CHECK((FixedPoint<4>::fromRaw(246) * SensorValue::fromRaw(-2055)).raw() ==
+          -5055);
+    CHECK((SensorValue::fromRaw(150) * SensorValue::fromRaw(150)).raw() ==
+          225);
+    CHECK((SensorValue::fromRaw(-5) * SensorValue::fromRaw(10)).raw() == -1);
+    CHECK((SensorValue::fromRaw(-4) * SensorValue::fromRaw(10)).raw() == 0);
+    CHECK((SensorValue(1000) * FixedPoint<4>::fromRaw(-12345)).raw() ==
+          -123450);
+
+    // Large values that exceed 32 bit intermediate results
+    CHECK((SensorValue(20000) * SensorValue(1000)).raw() == 2000000000);
+    CHECK(SensorValue(20000) * SensorValue(2000) == SensorValue::max());
+    CHECK(SensorValue(-20000) * SensorValue(2000) == SensorValue::min());
+    CHECK(SensorValue::max() * SensorValue(1) == SensorValue::max());
+    CHECK(SensorValue::max() * SensorValue(0) == 0);
+}
+
+/*!
+ * \brief Tests Sensors::FixedPoint::multiply() with unsigned integers.
+ */
+TEST_CASE("FixedPointMultiplyInteger", "[fixedpoint]")
+{
+    auto factor = FixedPoint<4>::fromRaw(7824);
+    CHECK(factor.multiply(90000) == 70416U);
+    CHECK(factor.multiply(6666) == 5215U);
+    CHECK(factor.multiply(0) == 0U);
+    CHECK(factor.multiply(UINT32_MAX) == 3360382411U);
+    CHECK(FixedPoint<4>(2).multiply(UINT32_MAX) == UINT32_MAX);
+    CHECK(FixedPoint<4>(-1).multiply(1000) == 0U);
+}
+
+/*!
+ * \brief Tests comparison of Sensors::FixedPoint.
+ */
+TEST_CASE("FixedPointComparison", "[fixedpoint]")
+{
+    auto a = SensorValue::fromRaw(-100);
+    auto b = SensorValue::fromRaw(250);
+
+    CHECK(a == SensorValue(-1));
+    CHECK(a != b);
+    CHECK(a < b);
+    CHECK(a <= b);
+    CHECK(b > a);
+    CHECK(b >= a);
+    CHECK(b >= b);
+    CHECK_FALSE(b < b);
+}
+
+/*!
+ * \brief Tests the decimal formatting of Sensors::FixedPoint.
+ */
+TEST_CASE("FixedPointFormat", "[fixedpoint]")
+{
+    CHECK(format(SensorValue()) == "0.00");
+    CHECK(format(SensorValue::fromRaw(2480)) == "24.80");
+    CHECK(format(SensorValue::fromRaw(-5)) == "-0.05");
+    CHECK(format(SensorValue::fromRaw(-101325)) == "-1013.25");
+    CHECK(format(FixedPoint<4>::fromRaw(7824)) == "0.7824");
+    CHECK(format(FixedPoint<0>(-42)) == "-42");
+    CHECK(format(FixedPoint<1>::min()) == "-214748364.7");
+    CHECK(format(FixedPoint<4>::max()) == "214748.3647");
+
+    SECTION("Buffer Size") {
+        char str[6] = "xxxxx";
+        CHECK(SensorValue::fromRaw(2480).format(str, sizeof(str)) == 5);
+        CHECK(std::string(str) == "24.80");
+        CHECK(SensorValue::fromRaw(-2480).format(str, sizeof(str)) == 0);
+        CHECK(std::string(str) == "");
+        CHECK(SensorValue().format(str, 0) == 0);
+    }
+}
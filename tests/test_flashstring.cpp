@@ -0,0 +1,51 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_tests
+ *
+ * \brief Unit tests for Sensors::FlashString.
+ */
+
+#include <string>
+
+#include <catch.hpp>
+
+#include "lib/flashstring.h"
+
+using ::Sensors::FlashString;
+
+/*!
+ * \brief Tests reading Sensors::FlashString character wise and in chunks.
+ */
+TEST_CASE("FlashStringRead", "[flashstring]")
+{
+    FlashString str = FLASH_STRING("VERSION: 1.0");
+    CHECK(str.length() == 12);
+    CHECK(str[0] == 'V');
+    CHECK(str[11] == '0');
+    CHECK(str[12] == '\0');
+
+    char chunk[4] = {0, 0, 0, 0};
+    str.copy(9, 3, chunk);
+    CHECK(std::string(chunk) == "1.0");
+
+    CHECK(FLASH_STRING("").length() == 0);
+}
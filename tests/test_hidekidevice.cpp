@@ -36,6 +36,10 @@ using ::std::extent;
 using ::Sensors::HidekiSensor;
 using ::Sensors::HidekiDevice;
 using ::Sensors::RfDeviceStatus;
+using ::Sensors::NoRfDeviceStatistics;
+using ::Sensors::RfDeviceStatistics;
+using ::Sensors::PackedRfDeviceState;
+using ::Sensors::SensorValue;
 
 // Noise
 static const std::vector<uint16_t> noise = {
@@ -192,13 +196,13 @@ static const std::vector<uint16_t> message4 = {
 struct MessageParameter
 {
     MessageParameter(const std::vector<uint16_t> &message,
-                     float temperature = 0.0f, uint8_t humidity = 0) :
+                     SensorValue temperature = 0, uint8_t humidity = 0) :
         message(message), temperature(temperature), humidity(humidity)
     {
     }
 
     const std::vector<uint16_t> message;
-    const float temperature;
+    const SensorValue temperature;
     const uint8_t humidity;
 };
 
@@ -219,7 +223,7 @@ static void verifyHidekiDevice(const MessageParameter &param)
             ++messageCount;
 
             CHECK(hidekiDevice.message() == messageCount);
-            CHECK(hidekiDevice.temperatureF() == Approx(param.temperature));
+            CHECK(hidekiDevice.temperatureFixed() == param.temperature);
             CHECK(hidekiDevice.humidity() == param.humidity);
         }
     }
@@ -232,18 +236,80 @@ static void verifyHidekiDevice(const MessageParameter &param)
 TEST_CASE("HidekiDeviceReceivingMessages", "[hidekidevice]")
 {
     SECTION("Message 1") {
-        verifyHidekiDevice({message1, 24.8f, 12});
+        verifyHidekiDevice({message1, SensorValue::fromRaw(2480), 12});
     }
 
     SECTION("Message 2") {
-        verifyHidekiDevice({message2, 24.2f, 14});
+        verifyHidekiDevice({message2, SensorValue::fromRaw(2420), 14});
     }
 
     SECTION("Message 3") {
-        verifyHidekiDevice({message3, 24.2f, 12});
+        verifyHidekiDevice({message3, SensorValue::fromRaw(2420), 12});
     }
 
     SECTION("Message 4") {
-        verifyHidekiDevice({message4, 22.5f, 10});
+        verifyHidekiDevice({message4, SensorValue::fromRaw(2250), 10});
     }
 }
+
+/*!
+ * \brief Tests the decoder counters of Sensors::HidekiDevice.
+ */
+TEST_CASE("HidekiDeviceStatistics", "[hidekidevice]")
+{
+    HidekiDevice<200, 675, 675, 1150, RfDeviceStatistics> hidekiDevice;
+
+    // Counters are optional and don't add overhead by default
+    CHECK(sizeof(HidekiDevice<200, 675, 675, 1150>) <
+          sizeof(hidekiDevice));
+
+    for (const auto &pulseWidth : noise) {
+        hidekiDevice.addPulseWidth(pulseWidth);
+    }
+    const auto &statistics = hidekiDevice.statistics();
+    CHECK(statistics.pulses == noise.size());
+    CHECK(statistics.frames == 0);
+    CHECK(statistics.demodulatorErrors > 0);
+    CHECK(statistics.parityErrors == 1);
+
+    for (const auto &pulseWidth : message1) {
+        hidekiDevice.addPulseWidth(pulseWidth);
+    }
+    CHECK(statistics.pulses == noise.size() + message1.size());
+    CHECK(statistics.frames == 3);
+
+    hidekiDevice.resetStatistics();
+    CHECK(statistics.pulses == 0);
+    CHECK(statistics.frames == 0);
+    CHECK(statistics.demodulatorErrors == 0);
+    CHECK(statistics.parityErrors == 0);
+
+    // Pulse counters don't saturate within a report interval of noise
+    for (uint32_t i = 0; i < 70000; ++i) {
+        hidekiDevice.addPulseWidth(10);
+    }
+    CHECK(statistics.pulses == 70000);
+    CHECK(statistics.demodulatorErrors == 70000);
+}
+
+/*!
+ * \brief Tests Sensors::HidekiDevice with packed state.
+ */
+TEST_CASE("HidekiDevicePackedState", "[hidekidevice]")
+{
+    HidekiDevice<200, 675, 675, 1150, NoRfDeviceStatistics,
+                 PackedRfDeviceState> hidekiDevice;
+
+    CHECK(sizeof(hidekiDevice) < sizeof(HidekiDevice<200, 675, 675, 1150>));
+
+    int messageCount = 0;
+    for (const auto &pulseWidth : message1) {
+        if (hidekiDevice.addPulseWidth(pulseWidth) ==
+                RfDeviceStatus::Complete) {
+            ++messageCount;
+            CHECK(hidekiDevice.temperatureFixed() ==
+                  SensorValue::fromRaw(2480));
+        }
+    }
+    CHECK(messageCount == 3);
+}
@@ -32,6 +32,7 @@
 
 using ::Sensors::SensorStatus;
 using ::Sensors::HidekiSensor;
+using ::Sensors::SensorValue;
 
 /*!
  * \brief Tests Sensors::HidekiSensor with a correct message.
@@ -51,7 +52,7 @@ TEST_CASE("HidekiSensorCorrectMessage", "[hidekisensor]")
     CHECK(sensor.message() == 1);
     CHECK(sensor.isThermoHygro());
     CHECK(sensor.temperature() == 24);
-    CHECK(sensor.temperatureF() == Approx(24.8));
+    CHECK(sensor.temperatureFixed() == SensorValue::fromRaw(2480));
     CHECK(sensor.humidity() == 16);
 }
 
@@ -68,7 +69,7 @@ TEST_CASE("HidekiSensorNegativeTemperature", "[hidekisensor]")
 
     CHECK(status == SensorStatus::Complete);
     CHECK(sensor.isValid());
-    CHECK(sensor.temperatureF() == Approx(-24.8));
+    CHECK(sensor.temperatureFixed() == SensorValue::fromRaw(-2480));
 }
 
 /*!
@@ -96,7 +97,7 @@ TEST_CASE("HidekiSensorContinuousData", "[hidekisensor]")
     CHECK(sensor.message() == 1);
     CHECK(sensor.isThermoHygro());
     CHECK(sensor.temperature() == 24);
-    CHECK(sensor.temperatureF() == Approx(24.8));
+    CHECK(sensor.temperatureFixed() == SensorValue::fromRaw(2480));
     CHECK(sensor.humidity() == 16);
 
     status = sensor.addByte(0xFF);
@@ -109,6 +110,48 @@ TEST_CASE("HidekiSensorContinuousData", "[hidekisensor]")
     CHECK(sensor.isPossiblyValid() == false);
 }
 
+/*!
+ * \brief Tests that Sensors::HidekiSensor detects incorrect CRCs as soon as
+ *        the CRC bytes are added.
+ */
+TEST_CASE("HidekiSensorContinuousDataIncorrectCRC", "[hidekisensor]")
+{
+    std::vector<uint8_t> bytes = {0x9F, 0x2C, 0xCE, 0x5E, 0x48,
+                                  0xC2, 0x16, 0xFB, 0xDB, 0xFC};
+    auto sensor = HidekiSensor();
+
+    SECTION("CRC 1") {
+        bytes[8] = 0x00;
+        for (uint8_t i = 0; i < 8; ++i) {
+            CHECK(sensor.addByte(bytes[i]) == SensorStatus::Incomplete);
+        }
+        CHECK(sensor.addByte(bytes[8]) == SensorStatus::InvalidData);
+        CHECK(sensor.isPossiblyValid() == false);
+    }
+
+    SECTION("CRC 2") {
+        bytes[9] = 0x00;
+        for (uint8_t i = 0; i < 9; ++i) {
+            CHECK(sensor.addByte(bytes[i]) == SensorStatus::Incomplete);
+        }
+        CHECK(sensor.addByte(bytes[9]) == SensorStatus::InvalidData);
+        CHECK(sensor.isPossiblyValid() == false);
+        CHECK(sensor.isValid() == false);
+    }
+
+    SECTION("Restart After Reset") {
+        for (uint8_t i = 0; i < 5; ++i) {
+            sensor.addByte(bytes[i]);
+        }
+        sensor.reset();
+        for (uint8_t i = 0; i < 9; ++i) {
+            CHECK(sensor.addByte(bytes[i]) == SensorStatus::Incomplete);
+        }
+        CHECK(sensor.addByte(bytes[9]) == SensorStatus::Complete);
+        CHECK(sensor.isValid());
+    }
+}
+
 /*!
  * \brief Tests Sensors::HidekiSensor with an invalid message size.
  */
@@ -307,7 +350,7 @@ TEST_CASE("HidekiSensorNonThermo/HygroSensor", "[hidekisensor]")
         CHECK(sensor.isValid());
         CHECK(sensor.isThermoHygro() == false);
         CHECK(sensor.temperature() == 0);
-        CHECK(sensor.temperatureF() == Approx(0));
+        CHECK(sensor.temperatureFixed() == 0);
         CHECK(sensor.humidity() == 0);
     }
 
@@ -320,7 +363,7 @@ TEST_CASE("HidekiSensorNonThermo/HygroSensor", "[hidekisensor]")
         CHECK(sensor.isValid());
         CHECK(sensor.isThermoHygro() == false);
         CHECK(sensor.temperature() == 0);
-        CHECK(sensor.temperatureF() == Approx(0));
+        CHECK(sensor.temperatureFixed() == 0);
         CHECK(sensor.humidity() == 0);
     }
 }
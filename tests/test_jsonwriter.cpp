@@ -0,0 +1,119 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_tests
+ *
+ * \brief Unit tests for Sensors::JsonWriter.
+ */
+
+#include <string>
+
+#include <catch.hpp>
+
+#include "lib/jsonwriter.h"
+
+using ::Sensors::BufferSink;
+using ::Sensors::FixedPoint;
+using ::Sensors::JsonWriter;
+using ::Sensors::SensorValue;
+
+/*!
+ * \brief Tests Sensors::BufferSink.
+ */
+TEST_CASE("BufferSink", "[jsonwriter]")
+{
+    char str[4] = "xxx";
+    BufferSink sink(str, sizeof(str));
+    CHECK(std::string(sink.str()) == "");
+
+    sink.write('a');
+    sink.write('b');
+    sink.write('c');
+    CHECK(std::string(sink.str()) == "abc");
+    CHECK(sink.length() == 3);
+    CHECK_FALSE(sink.isOverflown());
+
+    sink.write('d');
+    CHECK(std::string(sink.str()) == "abc");
+    CHECK(sink.isOverflown());
+
+    sink.reset();
+    CHECK(std::string(sink.str()) == "");
+    CHECK(sink.length() == 0);
+    CHECK_FALSE(sink.isOverflown());
+}
+
+/*!
+ * \brief Tests Sensors::JsonWriter with nested objects and all value types.
+ */
+TEST_CASE("JsonWriterObjects", "[jsonwriter]")
+{
+    char str[128];
+    BufferSink sink(str, sizeof(str));
+    JsonWriter<BufferSink> json(sink);
+
+    SECTION("Empty") {
+        json.beginObject();
+        json.endObject();
+        CHECK(std::string(str) == "{}");
+    }
+
+    SECTION("Sensor") {
+        json.beginObject();
+        json.beginObject(FLASH_STRING("rf433_"), 3);
+        json.addValue(FLASH_STRING("temperature"), SensorValue::fromRaw(-500));
+        json.addUInt(FLASH_STRING("humidity"), 48);
+        json.addBool(FLASH_STRING("battery"), true);
+        json.endObject();
+        json.endObject();
+        CHECK(std::string(str) == "{\"rf433_3\":{\"temperature\":-5.00,"
+                                  "\"humidity\":48,\"battery\":true}}");
+    }
+
+    SECTION("Multiple Objects") {
+        json.beginObject();
+        json.beginObject(FLASH_STRING("a"));
+        json.addInt(FLASH_STRING("int"), INT32_MIN);
+        json.endObject();
+        json.beginObject(FLASH_STRING("b"));
+        json.addUInt(FLASH_STRING("uint"), UINT32_MAX);
+        json.addBool(FLASH_STRING("bool"), false);
+        json.addValue(FLASH_STRING("factor"), FixedPoint<4>::fromRaw(7824));
+        json.endObject();
+        json.addInt(FLASH_STRING("zero"), 0);
+        json.endObject();
+        CHECK(std::string(str) ==
+              "{\"a\":{\"int\":-2147483648},"
+              "\"b\":{\"uint\":4294967295,\"bool\":false,\"factor\":0.7824},"
+              "\"zero\":0}");
+    }
+
+    SECTION("Buffer Overflow") {
+        char small[8];
+        BufferSink smallSink(small, sizeof(small));
+        JsonWriter<BufferSink> smallJson(smallSink);
+        smallJson.beginObject();
+        smallJson.addInt(FLASH_STRING("value"), 42);
+        smallJson.endObject();
+        CHECK(std::string(small) == "{\"value");
+        CHECK(smallSink.isOverflown());
+    }
+}
@@ -0,0 +1,188 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_tests
+ *
+ * \brief Unit tests for Sensors::MessageQueue.
+ */
+
+#include <string>
+
+#include <catch.hpp>
+
+#include "lib/messagequeue.h"
+
+using ::Sensors::DropPolicy;
+using ::Sensors::MessageQueue;
+
+namespace
+{
+
+template <typename TQueue>
+bool push(TQueue &queue, const std::string &message)
+{
+    return queue.push(reinterpret_cast<const uint8_t *>(message.data()),
+                      message.size());
+}
+
+template <typename TQueue>
+std::string pop(TQueue &queue)
+{
+    uint8_t buffer[UINT8_MAX];
+    uint8_t length = queue.pop(buffer, sizeof(buffer));
+    return std::string(reinterpret_cast<const char *>(buffer), length);
+}
+
+template <typename TQueue>
+std::string popBytes(TQueue &queue)
+{
+    std::string result;
+    uint8_t byte;
+    while (queue.pop(byte)) {
+        result += static_cast<char>(byte);
+    }
+    return result;
+}
+
+}  // namespace
+
+/*!
+ * \brief Tests Sensors::MessageQueue with messages removed as a whole.
+ */
+TEST_CASE("MessageQueuePushPop", "[messagequeue]")
+{
+    MessageQueue<10> queue;
+
+    CHECK(queue.isEmpty());
+    CHECK(pop(queue) == "");
+
+    // Wrap around the end of the buffer multiple times
+    for (int i = 0; i < 20; ++i) {
+        std::string message = std::to_string(i) + "abc";
+        CHECK(push(queue, message));
+        CHECK(queue.size() == message.size() + 1);
+        CHECK(pop(queue) == message);
+        CHECK(queue.isEmpty());
+    }
+
+    CHECK(push(queue, "abcd"));
+    CHECK(push(queue, "efgh"));
+    CHECK(queue.size() == 10);
+    CHECK(pop(queue) == "abcd");
+    CHECK(pop(queue) == "efgh");
+    CHECK(queue.dropped() == 0);
+
+    // Empty messages are not stored
+    CHECK(push(queue, ""));
+    CHECK(queue.isEmpty());
+
+    // Messages exceeding the destination buffer are dropped
+    uint8_t buffer[2];
+    CHECK(push(queue, "abc"));
+    CHECK(queue.pop(buffer, sizeof(buffer)) == 0);
+    CHECK(queue.isEmpty());
+    CHECK(queue.dropped() == 1);
+}
+
+/*!
+ * \brief Tests Sensors::MessageQueue with messages streamed byte by byte.
+ */
+TEST_CASE("MessageQueueStream", "[messagequeue]")
+{
+    MessageQueue<8> queue;
+    uint8_t byte;
+
+    CHECK(queue.pop(byte) == false);
+
+    CHECK(push(queue, "abc"));
+    CHECK(push(queue, "de"));
+    CHECK(queue.pop(byte));
+    CHECK(byte == 'a');
+
+    // Space of the consumed bytes is available again
+    CHECK(push(queue, "fg"));
+    CHECK(popBytes(queue) == "bcdefg");
+    CHECK(queue.isEmpty());
+
+    for (int i = 0; i < 20; ++i) {
+        CHECK(push(queue, "xyz"));
+        CHECK(popBytes(queue) == "xyz");
+    }
+}
+
+/*!
+ * \brief Tests Sensors::MessageQueue dropping new messages if it is full.
+ */
+TEST_CASE("MessageQueueDropNewest", "[messagequeue]")
+{
+    MessageQueue<8, DropPolicy::DropNewest> queue;
+
+    CHECK(push(queue, "abc"));
+    CHECK(push(queue, "def"));
+    CHECK(push(queue, "g") == false);
+    CHECK(push(queue, "too long") == false);
+    CHECK(queue.dropped() == 2);
+
+    CHECK(pop(queue) == "abc");
+    CHECK(pop(queue) == "def");
+    CHECK(queue.isEmpty());
+}
+
+/*!
+ * \brief Tests Sensors::MessageQueue dropping the oldest messages if it is
+ *        full.
+ */
+TEST_CASE("MessageQueueDropOldest", "[messagequeue]")
+{
+    MessageQueue<8, DropPolicy::DropOldest> queue;
+
+    CHECK(push(queue, "ab"));
+    CHECK(push(queue, "cd"));
+    CHECK(push(queue, "e"));
+    CHECK(push(queue, "fghi"));
+    CHECK(queue.dropped() == 2);
+
+    // Messages larger than the queue never fit
+    CHECK(push(queue, "too long") == false);
+    CHECK(queue.dropped() == 3);
+
+    CHECK(pop(queue) == "e");
+    CHECK(pop(queue) == "fghi");
+    CHECK(queue.isEmpty());
+}
+
+/*!
+ * \brief Tests Sensors::MessageQueue drop counter saturation.
+ */
+TEST_CASE("MessageQueueDropSaturation", "[messagequeue]")
+{
+    MessageQueue<2> queue;
+
+    CHECK(push(queue, "a"));
+    for (uint32_t i = 0; i < UINT16_MAX + 10UL; ++i) {
+        push(queue, "b");
+    }
+    CHECK(queue.dropped() == UINT16_MAX);
+    CHECK(pop(queue) == "a");
+
+    queue.resetDropped();
+    CHECK(queue.dropped() == 0);
+}
@@ -0,0 +1,159 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_tests
+ *
+ * \brief Unit tests for Sensors::RingBuffer.
+ */
+
+#include <thread>
+
+#include <catch.hpp>
+
+#include "lib/ringbuffer.h"
+
+using ::Sensors::RingBuffer;
+
+/*!
+ * \brief Tests Sensors::RingBuffer with alternating push and pop.
+ */
+TEST_CASE("RingBufferPushPop", "[ringbuffer]")
+{
+    RingBuffer<uint16_t, 4> buffer;
+    uint16_t value = 0;
+
+    CHECK(buffer.isEmpty());
+    CHECK(buffer.size() == 0);
+    CHECK(buffer.capacity() == 4);
+    CHECK(buffer.pop(value) == false);
+
+    // Wrap around the index range multiple times
+    for (uint16_t i = 0; i < 1000; ++i) {
+        CHECK(buffer.push(i));
+        CHECK(buffer.size() == 1);
+        CHECK(buffer.pop(value));
+        CHECK(value == i);
+        CHECK(buffer.isEmpty());
+    }
+    CHECK(buffer.overflows() == 0);
+}
+
+/*!
+ * \brief Tests Sensors::RingBuffer when more values are pushed than the
+ *        buffer can hold.
+ */
+TEST_CASE("RingBufferOverflow", "[ringbuffer]")
+{
+    RingBuffer<uint16_t, 4> buffer;
+    uint16_t value = 0;
+
+    for (uint16_t i = 0; i < 4; ++i) {
+        CHECK(buffer.push(i));
+    }
+    CHECK(buffer.size() == 4);
+
+    CHECK(buffer.push(100) == false);
+    CHECK(buffer.push(101) == false);
+    CHECK(buffer.overflows() == 2);
+
+    // Dropped values are not stored, the oldest values are retained
+    for (uint16_t i = 0; i < 4; ++i) {
+        CHECK(buffer.pop(value));
+        CHECK(value == i);
+    }
+    CHECK(buffer.pop(value) == false);
+
+    // Space is available again after consuming
+    CHECK(buffer.push(5));
+    CHECK(buffer.overflows() == 2);
+}
+
+/*!
+ * \brief Tests Sensors::RingBuffer overflow counter saturation.
+ */
+TEST_CASE("RingBufferOverflowSaturation", "[ringbuffer]")
+{
+    RingBuffer<uint8_t, 1> buffer;
+
+    CHECK(buffer.push(1));
+    for (uint32_t i = 0; i < UINT16_MAX + 10UL; ++i) {
+        buffer.push(2);
+    }
+    CHECK(buffer.overflows() == UINT16_MAX);
+}
+
+/*!
+ * \brief Tests Sensors::RingBuffer with the maximum capacity.
+ */
+TEST_CASE("RingBufferMaximumCapacity", "[ringbuffer]")
+{
+    RingBuffer<uint8_t, 128> buffer;
+    uint8_t value = 0;
+
+    for (uint16_t round = 0; round < 3; ++round) {
+        for (uint8_t i = 0; i < 128; ++i) {
+            CHECK(buffer.push(i));
+        }
+        CHECK(buffer.size() == 128);
+        CHECK(buffer.push(0) == false);
+
+        for (uint8_t i = 0; i < 128; ++i) {
+            CHECK(buffer.pop(value));
+            CHECK(value == i);
+        }
+        CHECK(buffer.isEmpty());
+    }
+}
+
+/*!
+ * \brief Tests Sensors::RingBuffer with producer and consumer running in
+ *        different threads.
+ */
+TEST_CASE("RingBufferConcurrent", "[ringbuffer]")
+{
+    static const uint32_t c_count = 10000;
+    RingBuffer<uint32_t, 8> buffer;
+
+    std::thread producer([&buffer]() {
+        for (uint32_t i = 0; i < c_count; ++i) {
+            while (!buffer.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    // Check in the main thread only, Catch is not thread safe
+    bool inOrder = true;
+    uint32_t expected = 0;
+    uint32_t value = 0;
+    while (expected < c_count) {
+        if (buffer.pop(value)) {
+            inOrder = inOrder && value == expected;
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    CHECK(inOrder);
+    CHECK(buffer.isEmpty());
+}
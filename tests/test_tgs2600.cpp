@@ -64,7 +64,7 @@ TEST_CASE("Tgs2600Calibration", "[tgs2600]")
     // With reference (37%, 20°C, factor 0.7824)
     tgs2600.setReferenceHumidity(37);
     tgs2600.setReferenceTemperature(20);
-    CHECK(tgs2600.calibration() == Approx(0.7824));
+    CHECK(tgs2600.calibration() == TestTgs2600::Factor::fromRaw(7824));
 }
 
 /*!
@@ -94,16 +94,15 @@ TEST_CASE("Tgs2600RelativeResistance", "[tgs2600]")
 {
     TestTgs2600 tgs2600;
 
-    float reference = 2500.0F;
-    tgs2600.setReferenceResistance(reference);
+    tgs2600.setReferenceResistance(2500);
 
-    CHECK(tgs2600.sensorResistanceRelative( 500) == Approx(36.0f));
-    CHECK(tgs2600.sensorResistanceRelative(1000) == Approx(16.0f));
-    CHECK(tgs2600.sensorResistanceRelative(2000) == Approx( 6.0f));
-    CHECK(tgs2600.sensorResistanceRelative(3000) == Approx( 2.6664f));
-    CHECK(tgs2600.sensorResistanceRelative(4000) == Approx( 1.0f));
-    CHECK(tgs2600.sensorResistanceRelative(5000) == Approx( 0.0f));
-    CHECK(tgs2600.sensorResistanceRelative(8000) == Approx( 0.0f));
+    CHECK(tgs2600.sensorResistanceRelative( 500).raw() == 360000);
+    CHECK(tgs2600.sensorResistanceRelative(1000).raw() == 160000);
+    CHECK(tgs2600.sensorResistanceRelative(2000).raw() ==  60000);
+    CHECK(tgs2600.sensorResistanceRelative(3000).raw() ==  26664);
+    CHECK(tgs2600.sensorResistanceRelative(4000).raw() ==  10000);
+    CHECK(tgs2600.sensorResistanceRelative(5000).raw() ==      0);
+    CHECK(tgs2600.sensorResistanceRelative(8000).raw() ==      0);
 }
 
 /*!
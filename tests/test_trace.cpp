@@ -0,0 +1,124 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_tests
+ *
+ * \brief Unit tests for Sensors::TraceBuffer,
+ *        Sensors::TraceSectionMatcher and Sensors::parseTraceRecord().
+ */
+
+#include <catch.hpp>
+
+#include "lib/trace.h"
+
+using ::Sensors::TraceBuffer;
+using ::Sensors::TraceRecord;
+using ::Sensors::TraceSection;
+using ::Sensors::TraceSectionMatcher;
+using ::Sensors::parseTraceRecord;
+using ::Sensors::c_traceEnd;
+
+/*!
+ * \brief Tests Sensors::TraceBuffer overwriting the oldest records.
+ */
+TEST_CASE("TraceBuffer", "[trace]")
+{
+    TraceBuffer<4> buffer;
+    CHECK(buffer.size() == 0);
+
+    buffer.add(1, 100);
+    buffer.add(2, 200);
+    CHECK(buffer.size() == 2);
+    CHECK(buffer[0].event == 1);
+    CHECK(buffer[0].timestamp == 100);
+    CHECK(buffer[1].event == 2);
+
+    for (uint16_t i = 3; i <= 300; ++i) {
+        buffer.add(i, i * 100);
+    }
+    CHECK(buffer.size() == 4);
+    for (uint8_t i = 0; i < 4; ++i) {
+        CHECK(buffer[i].event == static_cast<uint8_t>(297 + i));
+        CHECK(buffer[i].timestamp == static_cast<uint16_t>((297 + i) * 100));
+    }
+
+    buffer.clear();
+    CHECK(buffer.size() == 0);
+}
+
+/*!
+ * \brief Tests Sensors::TraceSectionMatcher with nested sections and
+ *        timer wrap around.
+ */
+TEST_CASE("TraceSectionMatcher", "[trace]")
+{
+    TraceSectionMatcher matcher;
+    TraceSection section;
+
+    CHECK_FALSE(matcher.add({0x41, 0xFF00}, section));
+    CHECK_FALSE(matcher.add({0x01, 0xFF80}, section));
+    CHECK(matcher.add({0x01 | c_traceEnd, 0xFFA0}, section));
+    CHECK(section.event == 0x01);
+    CHECK(section.begin == 0xFF80);
+    CHECK(section.duration == 0x20);
+    CHECK(section.depth == 1);
+
+    CHECK(matcher.add({0x41 | c_traceEnd, 0x0100}, section));
+    CHECK(section.event == 0x41);
+    CHECK(section.duration == 0x200);
+    CHECK(section.depth == 0);
+
+    // End without begin (e.g. begin overwritten in the trace buffer)
+    CHECK_FALSE(matcher.add({0x11 | c_traceEnd, 0x0200}, section));
+
+    // Unclosed inner sections are discarded
+    CHECK_FALSE(matcher.add({0x10, 0x0300}, section));
+    CHECK_FALSE(matcher.add({0x11, 0x0310}, section));
+    CHECK(matcher.add({0x10 | c_traceEnd, 0x0400}, section));
+    CHECK(section.event == 0x10);
+    CHECK(section.depth == 0);
+    CHECK_FALSE(matcher.add({0x11 | c_traceEnd, 0x0410}, section));
+}
+
+/*!
+ * \brief Tests Sensors::parseTraceRecord() with valid and invalid lines.
+ */
+TEST_CASE("TraceParseRecord", "[trace]")
+{
+    TraceRecord record;
+
+    CHECK(parseTraceRecord("c1 ffa0\n", record));
+    CHECK(record.event == 0xC1);
+    CHECK(record.timestamp == 0xFFA0);
+
+    CHECK(parseTraceRecord("01 00A0\r\n", record));
+    CHECK(record.event == 0x01);
+    CHECK(record.timestamp == 0x00A0);
+
+    CHECK_FALSE(parseTraceRecord("", record));
+    CHECK_FALSE(parseTraceRecord("TRACE 64", record));
+    CHECK_FALSE(parseTraceRecord("TRACE END", record));
+    CHECK_FALSE(parseTraceRecord("01 00A", record));
+    CHECK_FALSE(parseTraceRecord("01 00A00", record));
+    CHECK_FALSE(parseTraceRecord("001 00A0", record));
+    CHECK_FALSE(parseTraceRecord("01  00A0", record));
+    CHECK_FALSE(parseTraceRecord(" 01 00A0", record));
+}
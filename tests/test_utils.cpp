@@ -39,6 +39,7 @@ using ::Sensors::lowNibble;
 using ::Sensors::highNibble;
 using ::Sensors::word;
 using ::Sensors::parity;
+using ::Sensors::crc8Lsb;
 using ::Sensors::min;
 using ::Sensors::max;
 
@@ -155,6 +156,23 @@ TEST_CASE("BitOperationsCombiningBytesToWord", "[utils]")
     CHECK(word(0xAB, 0xCD) == 0xABCD);
 }
 
+/*!
+ * \brief Tests Sensors::crc8Lsb.
+ */
+TEST_CASE("Crc8Lsb", "[utils]")
+{
+    // Check value of CRC-8 (poly=0x07 refin=true refout=true)
+    const char *check = "123456789";
+    uint8_t crc = 0;
+    for (const char *c = check; *c; ++c) {
+        crc = crc8Lsb(crc, *c, 0xE0);
+    }
+    CHECK(crc == 0x20);
+
+    // Adding the CRC to itself results in 0
+    CHECK(crc8Lsb(crc, crc, 0xE0) == 0);
+}
+
 /*!
  * \brief Tests Sensors::parity.
  */
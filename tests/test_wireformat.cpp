@@ -0,0 +1,201 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*!
+ * \file
+ * \ingroup libsensors_tests
+ *
+ * \brief Unit tests for Sensors::WireFrame and Sensors::WireDecoder.
+ */
+
+#include <vector>
+
+#include <catch.hpp>
+
+#include "lib/wireformat.h"
+
+using ::Sensors::FixedPoint;
+using ::Sensors::SensorStatus;
+using ::Sensors::SensorValue;
+using ::Sensors::WireDecoder;
+using ::Sensors::WireFrame;
+using ::Sensors::WireQuantity;
+using ::Sensors::WireRecord;
+using ::Sensors::WireSensor;
+using ::Sensors::wireSensorId;
+
+namespace
+{
+struct VectorSink
+{
+    void write(char c)
+    {
+        data.push_back(static_cast<uint8_t>(c));
+    }
+
+    std::vector<uint8_t> data;
+};
+
+template <uint16_t TCapacity>
+SensorStatus decode(WireDecoder<TCapacity> &decoder,
+                    const std::vector<uint8_t> &data)
+{
+    SensorStatus status = SensorStatus::Incomplete;
+    for (uint8_t byte : data) {
+        status = decoder.addByte(byte);
+    }
+    return status;
+}
+}  // namespace
+
+/*!
+ * \brief Tests the exact encoding of a Sensors::WireFrame.
+ */
+TEST_CASE("WireFrameEncoding", "[wireformat]")
+{
+    WireFrame<16> frame;
+    VectorSink sink;
+
+    frame.begin();
+    frame.add(wireSensorId(WireSensor::Dht22), WireQuantity::Humidity,
+              SensorValue::fromRaw(0x1234));
+    frame.encode(sink);
+
+    // Payload: flags, sensor id, quantity | digits, value (LE), CRC
+    // 00 20 12 34 12 00 00 0A
+    std::vector<uint8_t> expected = {
+        0x01, 0x05, 0x20, 0x12, 0x34, 0x12, 0x01, 0x02, 0x0A, 0x00
+    };
+    CHECK(sink.data == expected);
+}
+
+/*!
+ * \brief Tests encoding and decoding of frames with all header variants.
+ */
+TEST_CASE("WireFrameRoundTrip", "[wireformat]")
+{
+    WireFrame<64> frame;
+    WireDecoder<80> decoder;
+    VectorSink sink;
+
+    SECTION("Plain") {
+        frame.begin();
+        frame.add(wireSensorId(WireSensor::Rf433, 3),
+                  WireQuantity::Temperature, SensorValue::fromRaw(-512));
+        frame.encode(sink);
+
+        REQUIRE(decode(decoder, sink.data) == SensorStatus::Complete);
+        CHECK(decoder.flags() == 0);
+        CHECK(decoder.sequence() == 0);
+        CHECK(decoder.timestamp() == 0);
+        REQUIRE(decoder.recordCount() == 1);
+        WireRecord record = decoder.record(0);
+        CHECK(record.sensorId == 0x13);
+        CHECK(record.quantity == WireQuantity::Temperature);
+        CHECK(record.digits == 2);
+        CHECK(record.raw == -512);
+    }
+
+    SECTION("Sequence") {
+        frame.begin(200);
+        frame.add(wireSensorId(WireSensor::Bmp180), WireQuantity::Pressure,
+                  SensorValue::fromRaw(101325));
+        frame.add(wireSensorId(WireSensor::Tgs2600),
+                  WireQuantity::Resistance, FixedPoint<0>(INT32_MIN + 1));
+        frame.encode(sink);
+
+        REQUIRE(decode(decoder, sink.data) == SensorStatus::Complete);
+        CHECK(decoder.sequence() == 200);
+        CHECK(decoder.timestamp() == 0);
+        REQUIRE(decoder.recordCount() == 2);
+        CHECK(decoder.record(0).sensorId == 0x30);
+        CHECK(decoder.record(0).raw == 101325);
+        CHECK(decoder.record(1).quantity == WireQuantity::Resistance);
+        CHECK(decoder.record(1).digits == 0);
+        CHECK(decoder.record(1).raw == INT32_MIN + 1);
+    }
+
+    SECTION("Timestamp") {
+        frame.begin(7, 0xDEADBEEF);
+        frame.encode(sink);
+
+        REQUIRE(decode(decoder, sink.data) == SensorStatus::Complete);
+        CHECK(decoder.sequence() == 7);
+        CHECK(decoder.timestamp() == 0xDEADBEEF);
+        CHECK(decoder.recordCount() == 0);
+    }
+}
+
+/*!
+ * \brief Tests that Sensors::WireFrame rejects values exceeding its
+ *        capacity.
+ */
+TEST_CASE("WireFrameCapacity", "[wireformat]")
+{
+    WireFrame<14> frame;  // Flags, 2 records, CRC
+    frame.begin();
+    CHECK(frame.add(0x20, WireQuantity::Temperature, SensorValue(1)));
+    CHECK(frame.add(0x20, WireQuantity::Humidity, SensorValue(2)));
+    CHECK_FALSE(frame.add(0x20, WireQuantity::Humidity, SensorValue(3)));
+}
+
+/*!
+ * \brief Tests Sensors::WireDecoder with corrupted and oversized frames and
+ *        resynchronization on the following frame.
+ */
+TEST_CASE("WireDecoderErrors", "[wireformat]")
+{
+    WireFrame<32> frame;
+    WireDecoder<32> decoder;
+    VectorSink sink;
+
+    frame.begin(1);
+    frame.add(0x20, WireQuantity::Temperature, SensorValue::fromRaw(2150));
+    frame.encode(sink);
+    std::vector<uint8_t> valid = sink.data;
+
+    SECTION("Leading delimiters") {
+        std::vector<uint8_t> data = { 0x00, 0x00 };
+        data.insert(data.end(), valid.begin(), valid.end());
+        CHECK(decode(decoder, data) == SensorStatus::Complete);
+    }
+
+    SECTION("Corrupted byte") {
+        std::vector<uint8_t> data = valid;
+        data[4] ^= 0x10;
+        CHECK(decode(decoder, data) == SensorStatus::InvalidData);
+        CHECK(decoder.recordCount() == 0);
+        CHECK(decode(decoder, valid) == SensorStatus::Complete);
+        CHECK(decoder.record(0).raw == 2150);
+    }
+
+    SECTION("Truncated frame") {
+        std::vector<uint8_t> data(valid.begin(), valid.begin() + 5);
+        data.push_back(0x00);
+        CHECK(decode(decoder, data) == SensorStatus::InvalidData);
+        CHECK(decode(decoder, valid) == SensorStatus::Complete);
+    }
+
+    SECTION("Too much data") {
+        std::vector<uint8_t> data(100, 0x42);
+        data.push_back(0x00);
+        CHECK(decode(decoder, data) == SensorStatus::TooMuchData);
+        CHECK(decode(decoder, valid) == SensorStatus::Complete);
+    }
+}
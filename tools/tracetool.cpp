@@ -0,0 +1,157 @@
+/*
+ * atMETEO - An ATmega based weather station
+ * Copyright (C) 2014-2015 Christian Fetzer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*!
+ * \defgroup tools_tracetool Trace analysis tool
+ * \ingroup libsensors
+ *
+ * \brief Converts a trace dump of the target into a timeline and latency
+ *        histograms.
+ *
+ * Usage: `tracetool [tick length in ns] < dump.txt`
+ *
+ * The dump is read from stdin (e.g. captured from the serial port after
+ * sending `t` to a firmware built with `-DTRACE=ON`). The tick length
+ * defaults to 500 ns (Timer1 with prescaler 8 at 16 MHz).
+ *
+ * The timeline lists all records with their time relative to the first
+ * record. For every section (matching begin and end events), the number of
+ * occurrences, the minimum, average and maximum duration and a histogram
+ * with power of two buckets are printed.
+ */
+
+/*!
+ * \file
+ * \ingroup tools_tracetool
+ * \copydoc tools_tracetool
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "lib/trace.h"
+
+using ::Sensors::TraceEvent;
+using ::Sensors::TraceRecord;
+using ::Sensors::TraceSection;
+using ::Sensors::TraceSectionMatcher;
+
+static std::string eventName(uint8_t event)
+{
+    event &= ~Sensors::c_traceEnd;
+    if (event >= static_cast<uint8_t>(TraceEvent::Task))
+        return "task_" + std::to_string(event -
+                                        static_cast<uint8_t>(TraceEvent::Task));
+
+    switch (static_cast<TraceEvent>(event)) {
+    case TraceEvent::InputCapture: return "isr_input_capture";
+    case TraceEvent::TimerOverflow: return "isr_timer_overflow";
+    case TraceEvent::Twi: return "isr_twi";
+    case TraceEvent::PinChange: return "isr_pin_change";
+    case TraceEvent::Format: return "format";
+    case TraceEvent::Uart: return "uart";
+    case TraceEvent::Udp: return "udp";
+    default: return "event_" + std::to_string(event);
+    }
+}
+
+struct SectionStatistics
+{
+    uint32_t count = 0;
+    uint32_t min = UINT32_MAX;
+    uint32_t max = 0;
+    uint64_t total = 0;
+    std::map<uint32_t, uint32_t> buckets;  // Upper bound (us) -> count
+
+    void add(uint32_t duration)
+    {
+        ++count;
+        min = std::min(min, duration);
+        max = std::max(max, duration);
+        total += duration;
+
+        uint32_t bucket = 1;
+        while (bucket * 1000 < duration)
+            bucket <<= 1;
+        ++buckets[bucket];
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    const uint32_t tickNs = argc > 1 ? std::strtoul(argv[1], nullptr, 10)
+                                     : 500;
+
+    std::vector<TraceRecord> records;
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        TraceRecord record;
+        if (Sensors::parseTraceRecord(line.c_str(), record))
+            records.push_back(record);
+    }
+    if (records.empty()) {
+        std::cerr << "No trace records found" << std::endl;
+        return 1;
+    }
+
+    // Timeline (the 16 bit timestamps are unwrapped assuming that
+    // consecutive records are less than one timer period apart)
+    std::printf("Timeline:\n%12s %10s  %s\n", "time [us]", "delta [us]",
+                "event");
+    uint64_t time = 0;
+    for (size_t i = 0; i < records.size(); ++i) {
+        uint16_t delta = i ? static_cast<uint16_t>(records[i].timestamp -
+                                                   records[i - 1].timestamp)
+                           : 0;
+        time += delta;
+        std::printf("%12.1f %10.1f  %s%s\n", time * tickNs / 1000.0,
+                    delta * tickNs / 1000.0,
+                    records[i].event & Sensors::c_traceEnd ? "end   "
+                                                           : "begin ",
+                    eventName(records[i].event).c_str());
+    }
+
+    // Section statistics
+    std::map<uint8_t, SectionStatistics> statistics;
+    TraceSectionMatcher matcher;
+    TraceSection section;
+    for (const auto &record : records) {
+        if (matcher.add(record, section))
+            statistics[section.event].add(section.duration * tickNs);
+    }
+
+    std::printf("\nSections (durations in us):\n");
+    for (const auto &entry : statistics) {
+        const SectionStatistics &s = entry.second;
+        std::printf("%-20s count %5u  min %9.1f  avg %9.1f  max %9.1f\n",
+                    eventName(entry.first).c_str(), s.count, s.min / 1000.0,
+                    s.total / 1000.0 / s.count, s.max / 1000.0);
+        for (const auto &bucket : s.buckets) {
+            std::printf("    <= %7u us %5u %s\n", bucket.first,
+                        bucket.second,
+                        std::string(bucket.second * 40 / s.count, '#')
+                            .c_str());
+        }
+    }
+    return 0;
+}
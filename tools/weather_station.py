@@ -33,6 +33,24 @@ import pywws.conversions
 import serial
 
 
+def split_lines(data):
+    """ Split received data into lines
+
+        A single UDP datagram contains all newline-delimited JSON objects of
+        a measurement cycle. """
+    return [line for line in data.decode().split('\n') if line]
+
+
+def test_split_lines():
+    """ Tests splitting single and batched messages """
+    assert split_lines(b'') == []
+    assert split_lines(b'\n') == []
+    assert split_lines(b'{"dht22":{}}') == ['{"dht22":{}}']
+    assert split_lines(b'{"dht22":{}}\n') == ['{"dht22":{}}']
+    assert split_lines(b'{"dht22":{}}\n{"bmp180":{}}\n') == \
+        ['{"dht22":{}}', '{"bmp180":{}}']
+
+
 class ReceiverThread(threading.Thread):  # pragma: no cover
     """ Generic Thread for receiving data asynchronously """
     __metaclass__ = abc.ABCMeta
@@ -56,8 +74,7 @@ class ReceiverThread(threading.Thread):  # pragma: no cover
 
     def handle_received(self, source, data):
         """ Handle received data """
-        line = data.decode().rstrip('\n')
-        if line:
+        for line in split_lines(data):
             for handler in self._handler:
                 handler(source, line)
 
@@ -106,7 +123,7 @@ class UdpReceiverThread(ReceiverThread):  # pragma: no cover
 
     def receive(self):
         try:
-            data, source = self._connection.recvfrom(1024)
+            data, source = self._connection.recvfrom(2048)
             self.handle_received(source[0], data)
         except socket.timeout:
             pass